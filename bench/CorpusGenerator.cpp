@@ -0,0 +1,124 @@
+#include "CorpusGenerator.hpp"
+#include "DiskManager.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+class ZipfSampler {
+  private:
+    // variables
+    std::vector<double> cumulative;  // cumulative probability of each rank
+
+  public:
+    ZipfSampler(const std::size_t n, const double exponent)
+    /*
+     * Class constructor.
+     *
+     * Precompute the cumulative distribution, so sampling is a binary search.
+     */
+    {
+        this->cumulative.reserve(n);
+        double sum = 0.0;
+        for (std::size_t rank = 1; rank <= n; ++rank) {
+            sum += 1.0 / std::pow(static_cast<double>(rank), exponent);
+            this->cumulative.push_back(sum);
+        }
+        for (auto &value : this->cumulative) {
+            value /= sum;
+        }
+    }
+
+    std::size_t sample(std::mt19937_64 &rng) const
+    {
+        /*
+         * Return a rank in [0, n), where lower ranks are more likely.
+         */
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        const auto itr = std::lower_bound(this->cumulative.begin(), this->cumulative.end(), u);
+        return std::min(static_cast<std::size_t>(itr - this->cumulative.begin()), this->cumulative.size() - 1);
+    }
+};
+
+namespace CorpusGenerator {
+
+std::string make_word(const std::size_t rank)
+/*
+ * Turn a rank into a pronounceable, unique word (e.g., 0 -> "ba", 1 -> "be").
+ */
+{
+    static const char consonants[] = "bcdfghjklmnprstvwz";
+    static const char vowels[] = "aeiou";
+    std::string word;
+    std::size_t n = rank;
+    do {
+        word += consonants[n % 18];
+        n /= 18;
+        word += vowels[n % 5];
+        n /= 5;
+    } while (n != 0);
+    return word;
+}
+
+bool write_csv(const std::string &filename, const corpus_args_t &args)
+/*
+ * Write a frequency-table-like CSV: an id, a Zipf-distributed word, and numeric/text columns.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    std::mt19937_64 rng(args.seed);
+    const ZipfSampler sampler(args.vocabulary, args.zipf_exponent);
+    std::bernoulli_distribution is_quoted(args.quote_density);
+    std::uniform_int_distribution<int> frequency(1, 100000);
+    DiskManager::BufferedWriter writer(filename);
+    writer.write("Id,Word");
+    for (std::size_t column = 2; column < args.columns; ++column) {
+        writer.write(",Column" + std::to_string(column));
+    }
+    writer.put('\n');
+    for (std::size_t row = 0; row != args.rows; ++row) {
+        writer.write(std::to_string(row));
+        writer.put(',');
+        writer.write(make_word(sampler.sample(rng)));
+        for (std::size_t column = 2; column < args.columns; ++column) {
+            writer.put(',');
+            if (column % 2 == 0) {
+                // numeric column, e.g., a frequency or a Zipf value
+                const int value = frequency(rng);
+                writer.write((column % 4 == 0) ? std::to_string(std::log10(value) + 3.0) : std::to_string(value));
+            }
+            else if (is_quoted(rng)) {
+                writer.write("\"note, with \"\"quotes\"\"\"");
+            }
+            else {
+                writer.write(make_word(sampler.sample(rng)));
+            }
+        }
+        writer.put('\n');
+    }
+    return writer.flush();
+}
+
+bool write_words(const std::string &filename, const std::size_t amount, const std::size_t vocabulary, const std::uint64_t seed)
+/*
+ * Write "amount" distinct target words, drawn uniformly from the vocabulary.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    std::mt19937_64 rng(seed);
+    std::vector<std::size_t> ranks(vocabulary);
+    for (std::size_t i = 0; i != vocabulary; ++i) {
+        ranks[i] = i;
+    }
+    std::shuffle(ranks.begin(), ranks.end(), rng);
+    DiskManager::BufferedWriter writer(filename);
+    for (std::size_t i = 0; i != std::min(amount, vocabulary); ++i) {
+        writer.write(make_word(ranks[i]));
+        writer.put('\n');
+    }
+    return writer.flush();
+}
+
+}  // namespace CorpusGenerator
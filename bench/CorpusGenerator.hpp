@@ -0,0 +1,27 @@
+#pragma once
+
+// libraries
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// custom namespace
+namespace CorpusGenerator {
+
+// types
+struct corpus_args_t {
+    std::size_t rows;          // amount of rows, excluding the header
+    std::size_t columns;       // amount of columns, the word is always in column 1
+    std::size_t vocabulary;    // amount of distinct words
+    double quote_density;      // probability that a text field is quoted (and contains a comma or quote)
+    double zipf_exponent;      // skew of the word distribution, 1.0 is close to natural language
+    std::uint64_t seed;        // same seed, same file
+};
+
+// prototypes
+std::string make_word(const std::size_t rank);
+bool write_csv(const std::string &filename, const corpus_args_t &args);
+bool write_words(const std::string &filename, const std::size_t amount, const std::size_t vocabulary, const std::uint64_t seed);
+
+}  // namespace CorpusGenerator
@@ -0,0 +1,333 @@
+#include "CorpusGenerator.hpp"
+#include "Api.hpp"
+#include "ConsoleInput.hpp"
+#include "DiskManager.hpp"
+#include "Logger.hpp"
+#include "ProcessCSV.hpp"
+#include "WordMatcher.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class BenchHelper {
+  private:
+    // types
+    using clock_t = std::chrono::steady_clock;
+
+    struct result_t {
+        bool success;
+        double seconds;      // fastest run
+        std::size_t bytes;   // bytes processed by a run, for "mb_per_s"
+        std::size_t amount;  // rows (or words) processed by a run, for "rows_per_s"
+    };
+
+    // variables
+    std::string filename_csv;
+    std::string filename_words;
+    std::string filename_output;
+    std::size_t rows;
+    std::size_t targets;
+    std::size_t file_bytes = 0;
+    std::size_t words_bytes = 0;
+    std::size_t repeat;
+
+    template <typename F>
+    static bool run_in_child(F &&f, result_t &result, long &peak_rss_kb)
+    {
+        /*
+         * Run "f" in a forked child and return its result, along with the peak resident set size of that child alone.
+         * Every case gets a fresh process, so its peak isn't hidden by the peak of a case that ran before it.
+         *
+         * Return True if succeeded, False if failed.
+         */
+        int fds[2];
+        if (pipe(fds) == -1) {
+            return false;
+        }
+        // otherwise the child prints the output buffered so far once more
+        std::cout.flush();
+        const pid_t pid = fork();
+        if (pid == -1) {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            const result_t child_result = f();
+            const bool sent = (write(fds[1], &child_result, sizeof(child_result)) == static_cast<ssize_t>(sizeof(child_result)));
+            std::cout.flush();
+            std::fflush(nullptr);
+            _exit(sent ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        close(fds[1]);
+        const bool received = (read(fds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result)));
+        close(fds[0]);
+        int status;
+        struct rusage usage;
+        if (wait4(pid, &status, 0, &usage) == -1) {
+            return false;
+        }
+        peak_rss_kb = usage.ru_maxrss;
+        return received && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS && result.success;
+    }
+
+    template <typename F>
+    double best_of(F &&f) const
+    {
+        /*
+         * Run "f" several times and return the fastest run in seconds, which filters out noise.
+         */
+        double best = 0.0;
+        for (std::size_t i = 0; i != this->repeat; ++i) {
+            const auto start = clock_t::now();
+            f();
+            const double seconds = std::chrono::duration<double>(clock_t::now() - start).count();
+            if (i == 0 || seconds < best) {
+                best = seconds;
+            }
+        }
+        return best;
+    }
+
+    template <typename F>
+    void run_case(const std::string &name, F &&f) const
+    {
+        /*
+         * Run a single case in its own process and print its result as a CSV row.
+         */
+        result_t result{};
+        long peak_rss_kb = 0;
+        if (!run_in_child(f, result, peak_rss_kb)) {
+            std::cerr << "ERROR: case '" << name << "' failed for '" << this->filename_csv << "' and '" << this->filename_words << "'.\n";
+            return;
+        }
+        std::cout << name << ',' << this->rows << ',' << this->targets << ',' << this->file_bytes << ','
+                  << result.seconds << ','
+                  << (static_cast<double>(result.bytes) / 1e6 / result.seconds) << ','
+                  << (static_cast<double>(result.amount) / result.seconds) << ','
+                  << peak_rss_kb << '\n';
+    }
+
+    ConsoleInput::console_args_t make_args() const
+    {
+        /*
+         * Return the same arguments "main()" passes to "ProcessCSV::find_and_save()" by default, for the generated files.
+         */
+        ConsoleInput::console_args_t args;
+        args.argc = 0;
+        args.argv = nullptr;
+        args.filename_words = this->filename_words;
+        args.filename_csv = this->filename_csv;
+        args.filename_output = this->filename_output;
+        args.word_column_idx = 1;
+        args.output_format = OutputWriter::format_t::raw;
+        args.max_distance = 0;
+        args.all_matches = false;
+        args.incremental = false;
+        args.threads = 1;
+        args.read_ahead = false;
+        args.build_index = false;
+        args.build_cache = false;
+        args.serve = false;
+        args.stats = false;
+        args.verbose = false;
+        args.log_level = Logger::level_t::error;
+        return args;
+    }
+
+    result_t load_words() const
+    {
+        /*
+         * Load the words file and build its matcher, like every run does before scanning.
+         */
+        const ConsoleInput::console_args_t args = this->make_args();
+        DiskManager::LineFile words;
+        bool success = true;
+        const double seconds = this->best_of([&]() {
+            success = DiskManager::load_words_from_disk(args, words) && success;
+            const WordMatcher::Matcher matcher(words.get_lines());
+        });
+        return result_t{success, seconds, this->words_bytes, words.get_lines().size()};
+    }
+
+    result_t extract(const std::size_t threads, const bool all_matches) const
+    {
+        /*
+         * Run the commandline's entry point: load the words, scan the CSV and write the matching rows.
+         */
+        ConsoleInput::console_args_t args = this->make_args();
+        args.threads = threads;
+        args.all_matches = all_matches;
+        bool success = true;
+        const double seconds = this->best_of([&]() {
+            success = ProcessCSV::find_and_save(args) && success;
+        });
+        return result_t{success, seconds, this->file_bytes, this->rows};
+    }
+
+    result_t query(const bool indexed) const
+    {
+        /*
+         * Query a corpus that is already open through the library, as an embedding program (or "--serve") does.
+         */
+        Api::Corpus corpus;
+        DiskManager::LineFile lines;
+        if (!corpus.open(this->filename_csv) || (indexed && !corpus.build_index(1)) ||
+            !DiskManager::load_words_from_disk(this->make_args(), lines)) {
+            return result_t{false, 0.0, 0, 0};
+        }
+        const Api::WordSet words(std::vector<std::string>(lines.get_lines().begin(), lines.get_lines().end()));
+        const Api::query_t query;
+        std::vector<Api::match_t> matches;
+        bool success = true;
+        const double seconds = this->best_of([&]() {
+            success = corpus.query(words, query, matches) && success;
+        });
+        return result_t{success, seconds, this->file_bytes, this->rows};
+    }
+
+  public:
+    BenchHelper(const std::string &dir, const std::size_t rows, const std::size_t targets, const std::size_t repeat)
+    /*
+     * Class constructor.
+     */
+    {
+        this->filename_csv = dir + "/corpus_" + std::to_string(rows) + ".csv";
+        this->filename_words = dir + "/words_" + std::to_string(targets) + ".txt";
+        this->filename_output = dir + "/output.csv";
+        this->rows = rows;
+        this->targets = targets;
+        this->repeat = repeat;
+    }
+
+    void run()
+    {
+        /*
+         * Time the real entry points, each case in its own process: loading the words, extracting with
+         * "ProcessCSV::find_and_save()" (one thread, every thread, every match) and querying through "Api::Corpus"
+         * (scan and in-memory index). Extractions stop early once every target word was found, like real runs do.
+         */
+        this->file_bytes = std::filesystem::file_size(this->filename_csv);
+        this->words_bytes = std::filesystem::file_size(this->filename_words);
+        const std::size_t all_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        this->run_case("load_words", [&]() { return this->load_words(); });
+        this->run_case("extract", [&]() { return this->extract(1, false); });
+        this->run_case("extract_threads", [&]() { return this->extract(all_threads, false); });
+        this->run_case("extract_all", [&]() { return this->extract(1, true); });
+        this->run_case("query", [&]() { return this->query(false); });
+        this->run_case("query_index", [&]() { return this->query(true); });
+    }
+};
+
+std::vector<std::size_t> parse_list(const std::string &s)
+/*
+ * Split a comma-separated list of numbers, e.g., "10,1000,20000".
+ */
+{
+    std::vector<std::size_t> result;
+    std::stringstream stream(s);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        result.push_back(static_cast<std::size_t>(std::stoull(item)));
+    }
+    return result;
+}
+
+void print_help(const char *program_name)
+{
+    /*
+     * Print help message to console, to be called using "-h" or "--help".
+     */
+    std::cout << "usage: " << program_name
+              << " [-h | --help] [--rows <list>] [--targets <list>] [--columns <integer>] [--quote-density <float>] [--repeat <integer>] [--dir <path>]\n\n"
+                 "options:\n"
+                 "  -h | --help                 print this help message\n"
+                 "  --rows <list>               comma-separated amounts of rows of the generated CSV files (default: \"100000,1000000\")\n"
+                 "  --targets <list>            comma-separated amounts of target words (default: \"10,1000,20000\")\n"
+                 "  --columns <integer>         amount of columns of the generated CSV files (default: \"8\")\n"
+                 "  --quote-density <float>     probability that a text field is quoted (default: \"0.1\")\n"
+                 "  --repeat <integer>          run each case this many times and keep the fastest (default: \"3\")\n"
+                 "  --dir <path>                directory for the generated files (default: system temp directory)\n\n"
+                 "Results are printed as CSV: case,rows,targets,file_bytes,seconds,mb_per_s,rows_per_s,peak_rss_kb\n"
+                 "Every case runs in its own process, so \"peak_rss_kb\" belongs to that case alone.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::size_t> row_amounts = {100000, 1000000};
+    std::vector<std::size_t> target_amounts = {10, 1000, 20000};
+    CorpusGenerator::corpus_args_t corpus = {0, 8, 50000, 0.1, 1.0, 42};
+    std::size_t repeat = 3;
+    std::string dir = (std::filesystem::temp_directory_path() / "csv_valence_bench").string();
+    for (int i = 1; i < argc; ++i) {
+        const std::string name = argv[i];
+        if (name == "-h" || name == "--help") {
+            print_help(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "ERROR: argument '" << name << "' doesn't have a value.\n";
+            return -1;
+        }
+        const std::string value = argv[++i];
+        try {
+            if (name == "--rows") {
+                row_amounts = parse_list(value);
+            }
+            else if (name == "--targets") {
+                target_amounts = parse_list(value);
+            }
+            else if (name == "--columns") {
+                corpus.columns = std::max<std::size_t>(2, std::stoull(value));
+            }
+            else if (name == "--quote-density") {
+                corpus.quote_density = std::stod(value);
+            }
+            else if (name == "--repeat") {
+                repeat = std::max<std::size_t>(1, std::stoull(value));
+            }
+            else if (name == "--dir") {
+                dir = value;
+            }
+            else {
+                std::cerr << "ERROR: unknown argument '" << name << "'.\n";
+                return -1;
+            }
+        }
+        catch (const std::exception &e) {
+            std::cerr << "ERROR: invalid value '" << value << "' for argument '" << name << "'.\n";
+            return -1;
+        }
+    }
+    // messages of every match would be timed too
+    Logger::set_level(Logger::level_t::error);
+    std::filesystem::create_directories(dir);
+    // generate every file up front, so no case pays for it
+    for (const std::size_t rows : row_amounts) {
+        corpus.rows = rows;
+        if (!CorpusGenerator::write_csv(dir + "/corpus_" + std::to_string(rows) + ".csv", corpus)) {
+            return -1;
+        }
+    }
+    for (const std::size_t targets : target_amounts) {
+        if (!CorpusGenerator::write_words(dir + "/words_" + std::to_string(targets) + ".txt", targets, corpus.vocabulary, corpus.seed + 1)) {
+            return -1;
+        }
+    }
+    std::cout << "case,rows,targets,file_bytes,seconds,mb_per_s,rows_per_s,peak_rss_kb\n";
+    for (const std::size_t rows : row_amounts) {
+        for (const std::size_t targets : target_amounts) {
+            BenchHelper(dir, rows, targets, repeat).run();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,301 @@
+#include "Aggregate.hpp"
+#include "Logger.hpp"
+#include "Query.hpp"
+#include "Schema.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace {
+
+bool parse_function(const std::string &name, Aggregate::function_t &function)
+{
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](const unsigned char c) { return std::tolower(c); });
+    if (lower == "count") {
+        function = Aggregate::function_t::count;
+    }
+    else if (lower == "sum") {
+        function = Aggregate::function_t::sum;
+    }
+    else if (lower == "mean") {
+        function = Aggregate::function_t::mean;
+    }
+    else if (lower == "min") {
+        function = Aggregate::function_t::min;
+    }
+    else if (lower == "max") {
+        function = Aggregate::function_t::max;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void add_compensated(double &sum, double &compensation, const double number)
+/*
+ * Add "number" to "sum" using Neumaier's compensated summation: the rounding error of every addition is kept
+ * in "compensation", so "sum + compensation" doesn't depend on the order of the values (e.g., on "--threads").
+ */
+{
+    const double total = sum + number;
+    if (std::fabs(sum) >= std::fabs(number)) {
+        compensation += (sum - total) + number;
+    }
+    else {
+        compensation += (number - total) + sum;
+    }
+    sum = total;
+}
+
+}  // namespace
+
+namespace Aggregate {
+
+bool Table::parse(const std::string &text)
+/*
+ * Read a comma-separated list of aggregates, e.g.:
+ * count, sum(Freq), mean("LogFreq(Zipf)"), max(#3)
+ *
+ * Columns are written like in "--where": header names (double-quoted if they contain symbols) or "#" followed by an index.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    this->columns.clear();
+    std::size_t i = 0;
+    const auto skip_spaces = [&]() {
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) {
+            ++i;
+        }
+    };
+    const auto fail = [&](const std::string &expected) {
+        Logger::error() << "invalid '--aggregate' list '" << text << "': expected " << expected
+                        << " at position " << (i + 1) << ".";
+        return false;
+    };
+    do {
+        skip_spaces();
+        const std::size_t start = i;
+        while (i < text.size() && std::isalpha(static_cast<unsigned char>(text[i]))) {
+            ++i;
+        }
+        column_t column{function_t::count, "", "", 0};
+        if (!parse_function(text.substr(start, i - start), column.function)) {
+            i = start;
+            return fail("count, sum, mean, min or max");
+        }
+        skip_spaces();
+        if (column.function != function_t::count) {
+            if (i >= text.size() || text[i] != '(') {
+                return fail("'(' followed by a column");
+            }
+            ++i;
+            skip_spaces();
+            if (i < text.size() && text[i] == '"') {
+                // quotes inside are escaped by doubling them, like in "--where"
+                ++i;
+                while (true) {
+                    if (i >= text.size()) {
+                        return fail("a closing quote");
+                    }
+                    if (text[i] == '"') {
+                        if (i + 1 < text.size() && text[i + 1] == '"') {
+                            column.column_name += '"';
+                            i += 2;
+                            continue;
+                        }
+                        ++i;
+                        break;
+                    }
+                    column.column_name += text[i++];
+                }
+            }
+            else {
+                while (i < text.size() && text[i] != ')' && text[i] != ',' && !std::isspace(static_cast<unsigned char>(text[i]))) {
+                    column.column_name += text[i++];
+                }
+            }
+            skip_spaces();
+            if (column.column_name.empty()) {
+                return fail("a column (e.g., Freq, \"Part of speech\" or #3)");
+            }
+            if (i >= text.size() || text[i] != ')') {
+                return fail("')'");
+            }
+            ++i;
+        }
+        const std::size_t end = i;
+        column.name = text.substr(start, end - start);
+        this->columns.push_back(column);
+        skip_spaces();
+        if (i < text.size() && text[i] != ',') {
+            return fail("',' or the end of the list");
+        }
+    } while (i++ < text.size());
+    return true;
+}
+
+bool Table::resolve(const CsvReader::RowStore &header)
+/*
+ * Replace column names with indices, so rows are never searched by name.
+ *
+ * Return True if succeeded, False if a column doesn't exist.
+ */
+{
+    for (column_t &column : this->columns) {
+        if (column.function == function_t::count) {
+            continue;
+        }
+        if (!Query::find_column(header, column.column_name, column.column)) {
+            Logger::error() << "column '" << column.column_name << "' used in '--aggregate' doesn't exist in the header.";
+            return false;
+        }
+    }
+    return true;
+}
+
+void Table::reset(const std::size_t word_amount)
+/*
+ * Clear all totals and make room for "word_amount" target words.
+ * Memory depends only on the amount of target words, never on the amount of rows.
+ */
+{
+    this->row_counts.assign(word_amount, 0);
+    this->cells.assign(word_amount * this->columns.size(), cell_t());
+}
+
+void Table::add(const std::size_t word_idx, const CsvReader::row_t &row, std::string &buffer)
+/*
+ * Add a row that matched the target word at "word_idx" to its totals.
+ * Fields that are missing, empty or not numbers only count toward "count".
+ */
+{
+    this->add_row(word_idx);
+    for (std::size_t i = 0; i != this->columns.size(); ++i) {
+        const column_t &column = this->columns[i];
+        if (column.function != function_t::count && column.column < row.fields.size()) {
+            this->add_value(word_idx, i, CsvReader::field_value(row.fields[column.column], buffer));
+        }
+    }
+}
+
+void Table::add_row(const std::size_t word_idx)
+/*
+ * Count a matching row, without looking at its values (see "add_number()" and "add_value()" for those).
+ */
+{
+    ++this->row_counts[word_idx];
+}
+
+void Table::add_number(const std::size_t word_idx, const std::size_t column, const double number)
+/*
+ * Add a value of "column" (an index into the list, see "source()" for the CSV column), that is already a number.
+ */
+{
+    cell_t &cell = this->cells[word_idx * this->columns.size() + column];
+    cell.min = (cell.count == 0) ? number : std::min(cell.min, number);
+    cell.max = (cell.count == 0) ? number : std::max(cell.max, number);
+    add_compensated(cell.sum, cell.compensation, number);
+    ++cell.count;
+}
+
+void Table::add_value(const std::size_t word_idx, const std::size_t column, const std::string_view value)
+/*
+ * Add a value of "column" as written in the CSV; it's skipped unless it's a number.
+ */
+{
+    double number;
+    if (Schema::parse_real(value, number)) {
+        this->add_number(word_idx, column, number);
+    }
+}
+
+void Table::merge(const Table &other)
+/*
+ * Add the totals of "other" (e.g., of another chunk), which must have the same columns and target words.
+ */
+{
+    for (std::size_t word_idx = 0; word_idx != this->row_counts.size(); ++word_idx) {
+        this->row_counts[word_idx] += other.row_counts[word_idx];
+    }
+    for (std::size_t i = 0; i != this->cells.size(); ++i) {
+        cell_t &cell = this->cells[i];
+        const cell_t &other_cell = other.cells[i];
+        if (other_cell.count == 0) {
+            continue;
+        }
+        cell.min = (cell.count == 0) ? other_cell.min : std::min(cell.min, other_cell.min);
+        cell.max = (cell.count == 0) ? other_cell.max : std::max(cell.max, other_cell.max);
+        add_compensated(cell.sum, cell.compensation, other_cell.sum);
+        add_compensated(cell.sum, cell.compensation, other_cell.compensation);
+        cell.count += other_cell.count;
+    }
+}
+
+bool Table::empty() const
+{
+    return this->columns.empty();
+}
+
+std::size_t Table::size() const
+{
+    return this->columns.size();
+}
+
+const std::string &Table::name(const std::size_t column) const
+{
+    return this->columns[column].name;
+}
+
+std::size_t Table::source(const std::size_t column) const
+/*
+ * Return the CSV column that "column" (an index into the list) reads, or "npos" for "count".
+ */
+{
+    const column_t &entry = this->columns[column];
+    return (entry.function == function_t::count) ? std::string::npos : entry.column;
+}
+
+std::uint64_t Table::rows(const std::size_t word_idx) const
+{
+    return this->row_counts[word_idx];
+}
+
+void Table::value(const std::size_t word_idx, const std::size_t column, std::string &out) const
+/*
+ * Append the result of a column for the target word at "word_idx".
+ * Nothing is appended if the column had no numeric values for that word.
+ */
+{
+    const cell_t &cell = this->cells[word_idx * this->columns.size() + column];
+    const double sum = cell.sum + cell.compensation;
+    switch (this->columns[column].function) {
+    case function_t::count:
+        out += std::to_string(this->row_counts[word_idx]);
+        return;
+    case function_t::sum:
+        if (cell.count != 0) {
+            Schema::format_real(sum, out);
+        }
+        return;
+    case function_t::mean:
+        if (cell.count != 0) {
+            Schema::format_real(sum / static_cast<double>(cell.count), out);
+        }
+        return;
+    case function_t::min:
+        if (cell.count != 0) {
+            Schema::format_real(cell.min, out);
+        }
+        return;
+    case function_t::max:
+        if (cell.count != 0) {
+            Schema::format_real(cell.max, out);
+        }
+        return;
+    }
+}
+
+}  // namespace Aggregate
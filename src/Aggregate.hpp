@@ -0,0 +1,63 @@
+#pragma once
+
+// libraries
+#include "CsvReader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace Aggregate {
+
+// types
+enum class function_t {
+    count,  // amount of matching rows
+    sum,    // sum of numeric values in a column
+    mean,   // average of numeric values in a column
+    min,    // smallest numeric value in a column
+    max,    // largest numeric value in a column
+};
+
+struct column_t {
+    function_t function;
+    std::string name;         // as written in the list, e.g., "sum(Freq)"
+    std::string column_name;  // e.g., "Freq" or "#3", empty for "count"
+    std::size_t column = 0;   // resolved from "column_name" by "Table::resolve()"
+};
+
+class Table {
+  public:
+    bool parse(const std::string &text);
+    bool resolve(const CsvReader::RowStore &header);
+    void reset(const std::size_t word_amount);
+    void add(const std::size_t word_idx, const CsvReader::row_t &row, std::string &buffer);
+    void add_row(const std::size_t word_idx);
+    void add_number(const std::size_t word_idx, const std::size_t column, const double number);
+    void add_value(const std::size_t word_idx, const std::size_t column, const std::string_view value);
+    void merge(const Table &other);
+    bool empty() const;
+    std::size_t size() const;
+    const std::string &name(const std::size_t column) const;
+    std::size_t source(const std::size_t column) const;
+    std::uint64_t rows(const std::size_t word_idx) const;
+    void value(const std::size_t word_idx, const std::size_t column, std::string &out) const;
+
+  private:
+    // types
+    struct cell_t {
+        std::uint64_t count = 0;  // amount of numeric values, the rest (e.g., empty fields) is skipped
+        double sum = 0;
+        double compensation = 0;  // low-order bits lost by "sum", see "add_compensated()"
+        double min = 0;
+        double max = 0;
+    };
+
+    // variables
+    std::vector<column_t> columns;
+    std::vector<std::uint64_t> row_counts;  // one per target word
+    std::vector<cell_t> cells;              // one per target word and column, grouped by target word
+};
+
+}  // namespace Aggregate
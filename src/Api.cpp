@@ -0,0 +1,238 @@
+#include "Api.hpp"
+#include "InputStream.hpp"
+#include "Logger.hpp"
+#include "Scan.hpp"
+#include <algorithm>
+#include <filesystem>
+
+namespace Api {
+
+WordSet::WordSet(const std::vector<std::string> &words, const Normalizer::options_t &options, const std::size_t max_distance)
+/*
+ * Class constructor.
+ *
+ * Build the matcher once, so every query against any corpus only pays for the lookups.
+ * Duplicate words are ignored, so indices refer to the first occurrence of every word.
+ */
+    : matcher(words, options, max_distance)
+{
+}
+
+std::size_t WordSet::size() const
+{
+    return this->matcher.size();
+}
+
+std::size_t WordSet::duplicate_count() const
+{
+    return this->matcher.duplicate_count();
+}
+
+std::string_view WordSet::word(const std::size_t idx) const
+{
+    return this->matcher.word(idx);
+}
+
+const WordMatcher::Matcher &WordSet::get_matcher() const
+{
+    return this->matcher;
+}
+
+bool Corpus::open(const std::string &filename)
+/*
+ * Map an uncompressed CSV into memory and read its header, so queries start scanning right away.
+ * Column types are inferred once, like the commandline does for every run.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    this->close();
+    if (!std::filesystem::is_regular_file(filename)) {
+        Logger::error() << "corpus doesn't exist: '" << filename << "'.";
+        return false;
+    }
+    const InputStream::format_t format = InputStream::detect_format(filename);
+    if (format != InputStream::format_t::plain) {
+        Logger::error() << "cannot open '" << filename << "' as a corpus, because it is "
+                        << InputStream::format_name(format) << "-compressed. Please decompress it first.";
+        return false;
+    }
+    if (!this->file.emplace(filename).is_open()) {
+        this->file.reset();
+        return false;
+    }
+    const std::string_view data = this->file->data();
+    CsvReader::Reader reader(data);
+    CsvReader::row_t header_row;
+    reader.next_row(header_row);
+    this->header.add(header_row, 0);
+    this->rows_begin = reader.offset();
+    this->types = Schema::infer(data, this->rows_begin, this->header.field_count(0));
+    this->indexes.assign(this->header.field_count(0), {});
+    return true;
+}
+
+void Corpus::close()
+/*
+ * Unmap the CSV; all row views handed out by queries become invalid.
+ */
+{
+    this->file.reset();
+    this->header.clear();
+    this->types.clear();
+    this->rows_begin = 0;
+    this->indexes.clear();
+}
+
+bool Corpus::is_open() const
+{
+    return this->file.has_value();
+}
+
+const CsvReader::RowStore &Corpus::get_header() const
+{
+    return this->header;
+}
+
+const std::vector<Schema::type_t> &Corpus::get_types() const
+{
+    return this->types;
+}
+
+bool Corpus::build_index(const std::size_t column)
+/*
+ * Keep a table of (word hash, row offset) pairs of "column" in memory, sorted by hash, like "--build-index" does on disk.
+ * Queries of exact target words against that column then cost a binary search per word, instead of a scan.
+ * Not thread-safe: build every index before running queries from several threads.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    if (!this->file) {
+        Logger::error() << "cannot build an index, because no corpus is open.";
+        return false;
+    }
+    const std::size_t column_count = this->header.field_count(0);
+    if (column >= column_count) {
+        Logger::error() << "the target column index '" << column
+                        << "' is larger than the total amount of columns '" << column_count << "'.";
+        return false;
+    }
+    const std::string_view data = this->file->data();
+    std::vector<ColumnIndex::entry_t> &entries = this->indexes[column];
+    entries.clear();
+    CsvReader::Reader reader(data, this->rows_begin);
+    CsvReader::row_t row;
+    std::string key_buffer;
+    while (reader.next_row(row)) {
+        // rows with a wrong amount of columns are never reported, so they are left out
+        if (row.fields.size() != column_count) {
+            continue;
+        }
+        const auto row_offset = static_cast<std::uint64_t>(row.bytes.data() - data.data());
+        entries.push_back(ColumnIndex::entry_t{ColumnIndex::hash_key(CsvReader::field_value(row.fields[column], key_buffer)), row_offset});
+    }
+    // sorting by offset within the same hash keeps the first row of every word in front
+    std::sort(entries.begin(), entries.end(), [](const ColumnIndex::entry_t &a, const ColumnIndex::entry_t &b) {
+        return (a.hash != b.hash) ? a.hash < b.hash : a.offset < b.offset;
+    });
+    entries.shrink_to_fit();
+    return true;
+}
+
+bool Corpus::is_indexed(const std::size_t column) const
+{
+    return column < this->indexes.size() && !this->indexes[column].empty();
+}
+
+bool Corpus::query_index(const WordSet &words, const query_t &query, const Query::Predicate &where, const callback_t &callback) const
+/*
+ * Answer a query from the in-memory index of its column (see "build_index()"), for exact target words only.
+ * Candidate rows are re-read and compared (see "ColumnIndex::find_rows()"),
+ * and they are reported in the order of the CSV, like a scan would.
+ *
+ * Return True if succeeded, False if the index is stale (nothing is reported then).
+ */
+{
+    const std::vector<ColumnIndex::entry_t> &entries = this->indexes[query.column];
+    const std::string_view data = this->file->data();
+    std::vector<std::pair<std::size_t, std::size_t>> matches;  // (row offset, target word)
+    if (!ColumnIndex::find_rows(data, entries.data(), entries.data() + entries.size(), query.column,
+                                this->header.field_count(0), words.get_matcher(), where, query.all_matches, matches)) {
+        Logger::warning() << "the index of column no. '" << query.column << "' does not match the corpus, scanning it instead.";
+        return false;
+    }
+    CsvReader::row_t row;
+    for (const auto &[offset, word_idx] : matches) {
+        CsvReader::Reader row_reader(data, offset);
+        row_reader.next_row(row);
+        if (!callback(word_idx, offset, row)) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool Corpus::query(const WordSet &words, const query_t &query, const callback_t &callback) const
+/*
+ * Scan the corpus once and call "callback" for every row whose word in "query.column" matches a target word
+ * and which passes "query.where". Without "query.all_matches", only the first row of every target word is reported,
+ * and the scan stops once every target word was found.
+ *
+ * Exact target words are looked up in the index of the column, if there is one (see "build_index()").
+ * Queries only read the corpus and the word set, so any amount of them can run at the same time.
+ * Rows whose amount of columns is not equal to the header's are skipped, like in the commandline scan.
+ *
+ * Return True if succeeded, False if the query is invalid (nothing is reported then).
+ */
+{
+    if (!this->file) {
+        Logger::error() << "cannot run a query, because no corpus is open.";
+        return false;
+    }
+    const std::size_t column_count = this->header.field_count(0);
+    if (query.column >= column_count) {
+        Logger::error() << "the target column index '" << query.column
+                        << "' is larger than the total amount of columns '" << column_count << "'.";
+        return false;
+    }
+    std::vector<Schema::type_t> types = this->types;
+    std::vector<Schema::entry_t> schema;
+    if (!query.schema.empty() && !(Schema::parse(query.schema, schema) && Schema::apply(schema, this->header, types))) {
+        return false;
+    }
+    Query::Predicate where;
+    if (!query.where.empty() && !(where.parse(query.where) && where.resolve(this->header, types))) {
+        return false;
+    }
+    const WordMatcher::Matcher &matcher = words.get_matcher();
+    // the index only knows exact words
+    if (matcher.is_exact() && this->is_indexed(query.column) && this->query_index(words, query, where, callback)) {
+        return true;
+    }
+    std::vector<Scan::job_t> jobs{Scan::job_t{&matcher, &where, query.column, query.all_matches, 0, WordMatcher::Matcher::npos, {}}};
+    jobs.front().found.assign(matcher.size(), false);
+    const std::string_view data = this->file->data();
+    Scan::scan_rows(data, this->rows_begin, data.size(), 0, column_count, jobs, nullptr,
+                    [&](const std::size_t, const std::size_t word_idx, const bool, const std::size_t row_offset, const CsvReader::row_t &row) {
+                        return callback(word_idx, row_offset, row);
+                    },
+                    [](const std::size_t, const CsvReader::row_t &) {});
+    return true;
+}
+
+bool Corpus::query(const WordSet &words, const query_t &query, std::vector<match_t> &matches) const
+/*
+ * Same as above, but collect the matches instead; rows are views into the corpus, nothing is copied.
+ *
+ * Return True if succeeded, False if the query is invalid.
+ */
+{
+    matches.clear();
+    return this->query(words, query, [&](const std::size_t word, const std::size_t offset, const CsvReader::row_t &row) {
+        matches.push_back(match_t{word, offset, row.bytes});
+        return true;
+    });
+}
+
+}  // namespace Api
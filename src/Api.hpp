@@ -0,0 +1,74 @@
+#pragma once
+
+// libraries
+#include "ColumnIndex.hpp"
+#include "CsvReader.hpp"
+#include "Normalizer.hpp"
+#include "Query.hpp"
+#include "Schema.hpp"
+#include "WordMatcher.hpp"
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace Api {
+
+// types
+struct query_t {
+    std::size_t column = 1;    // column that contains words, same as "--column"
+    std::string where;         // same syntax as "--where", empty if rows aren't filtered
+    std::string schema;        // same syntax as "--schema", empty if column types are only inferred
+    bool all_matches = false;  // every matching row instead of the first one of each target word
+};
+
+struct match_t {
+    std::size_t word;      // index of the target word in the word set
+    std::size_t offset;    // byte offset of the row in the CSV file
+    std::string_view row;  // entire row, points into the corpus and stays valid until it's closed
+};
+
+// called for every match, in the order of the CSV; return False to stop the query early
+using callback_t = std::function<bool(const std::size_t word, const std::size_t offset, const CsvReader::row_t &row)>;
+
+class WordSet {
+  public:
+    explicit WordSet(const std::vector<std::string> &words,
+                     const Normalizer::options_t &options = {},
+                     const std::size_t max_distance = 0);
+
+    std::size_t size() const;
+    std::size_t duplicate_count() const;
+    std::string_view word(const std::size_t idx) const;
+    const WordMatcher::Matcher &get_matcher() const;
+
+  private:
+    WordMatcher::Matcher matcher;
+};
+
+class Corpus {
+  public:
+    bool open(const std::string &filename);
+    void close();
+    bool is_open() const;
+    const CsvReader::RowStore &get_header() const;
+    const std::vector<Schema::type_t> &get_types() const;
+    bool build_index(const std::size_t column);
+    bool is_indexed(const std::size_t column) const;
+    bool query(const WordSet &words, const query_t &query, const callback_t &callback) const;
+    bool query(const WordSet &words, const query_t &query, std::vector<match_t> &matches) const;
+
+  private:
+    std::optional<CsvReader::MappedFile> file;
+    CsvReader::RowStore header;
+    std::vector<Schema::type_t> types;  // inferred from the first rows, "--schema" of a query may override them
+    std::size_t rows_begin = 0;         // offset of the first row after the header
+    std::vector<std::vector<ColumnIndex::entry_t>> indexes;  // one per column, sorted by hash, empty if not built
+
+    bool query_index(const WordSet &words, const query_t &query, const Query::Predicate &where, const callback_t &callback) const;
+};
+
+}  // namespace Api
@@ -0,0 +1,174 @@
+#include "csv_valence.h"
+#include "Api.hpp"
+#include "Logger.hpp"
+#include <exception>
+#include <new>
+#include <string>
+#include <vector>
+
+struct csv_valence_corpus {
+    Api::Corpus corpus;
+};
+
+struct csv_valence_words {
+    Api::WordSet words;
+};
+
+int csv_valence_set_log_level(const char *level)
+/*
+ * Print only messages of "level" or above: "debug", "ok", "info", "warning" or "error" (default: "ok").
+ *
+ * Return 1 if succeeded, 0 if the level is unknown.
+ */
+{
+    Logger::level_t parsed;
+    if (level == nullptr || !Logger::parse_level(level, parsed)) {
+        return 0;
+    }
+    Logger::set_level(parsed);
+    return 1;
+}
+
+csv_valence_corpus *csv_valence_open(const char *filename)
+/*
+ * Map an uncompressed CSV into memory and read its header.
+ *
+ * Return the corpus, or NULL if it couldn't be opened. Close it using "csv_valence_close()".
+ */
+{
+    if (filename == nullptr) {
+        return nullptr;
+    }
+    try {
+        auto *corpus = new csv_valence_corpus;
+        if (!corpus->corpus.open(filename)) {
+            delete corpus;
+            return nullptr;
+        }
+        return corpus;
+    }
+    catch (const std::exception &e) {
+        // exceptions must not cross the C boundary
+        Logger::error() << "could not open corpus '" << filename << "': " << e.what() << ".";
+        return nullptr;
+    }
+}
+
+void csv_valence_close(csv_valence_corpus *corpus)
+{
+    delete corpus;
+}
+
+size_t csv_valence_column_count(const csv_valence_corpus *corpus)
+{
+    return (corpus == nullptr) ? 0 : corpus->corpus.get_header().field_count(0);
+}
+
+const char *csv_valence_column_name(const csv_valence_corpus *corpus, size_t column, size_t *size)
+/*
+ * Return the name of "column" in the header (NOT null-terminated, its length is saved to "size"),
+ * or NULL if the column doesn't exist.
+ */
+{
+    if (column >= csv_valence_column_count(corpus)) {
+        return nullptr;
+    }
+    const std::string_view name = corpus->corpus.get_header().field(0, column);
+    if (size != nullptr) {
+        *size = name.size();
+    }
+    return name.data();
+}
+
+csv_valence_words *csv_valence_words_new(const char *const *words, size_t count, const char *normalize, size_t max_distance)
+/*
+ * Prepare "count" target words for queries. "normalize" uses the same syntax as "--normalize" (NULL or "" for none),
+ * and "max_distance" is the same as "--max-distance".
+ *
+ * Return the word set, or NULL if "normalize" is invalid. Free it using "csv_valence_words_free()".
+ */
+{
+    if (words == nullptr && count != 0) {
+        return nullptr;
+    }
+    try {
+        Normalizer::options_t options;
+        if (normalize != nullptr && *normalize != '\0' && !Normalizer::parse_options(normalize, options)) {
+            return nullptr;
+        }
+        const std::vector<std::string> list(words, words + count);
+        return new csv_valence_words{Api::WordSet(list, options, max_distance)};
+    }
+    catch (const std::exception &e) {
+        Logger::error() << "could not prepare target words: " << e.what() << ".";
+        return nullptr;
+    }
+}
+
+void csv_valence_words_free(csv_valence_words *words)
+{
+    delete words;
+}
+
+size_t csv_valence_words_size(const csv_valence_words *words)
+/*
+ * Return the amount of unique target words, duplicates are only counted once.
+ */
+{
+    return (words == nullptr) ? 0 : words->words.size();
+}
+
+const char *csv_valence_words_get(const csv_valence_words *words, size_t idx)
+/*
+ * Return the target word at "idx" (null-terminated), or NULL if there is none.
+ */
+{
+    if (idx >= csv_valence_words_size(words)) {
+        return nullptr;
+    }
+    // target words are stored null-terminated
+    return words->words.word(idx).data();
+}
+
+long long csv_valence_run(const csv_valence_corpus *corpus,
+                          const csv_valence_words *words,
+                          const csv_valence_query *query,
+                          csv_valence_callback callback,
+                          void *user_data)
+/*
+ * Run a query and call "callback" for every match (see "Api::Corpus::query()").
+ * "callback" may be NULL to only count the matches.
+ *
+ * Return the amount of matches that were reported, or -1 if the query is invalid.
+ */
+{
+    if (corpus == nullptr || words == nullptr || query == nullptr) {
+        return -1;
+    }
+    try {
+        Api::query_t api_query;
+        api_query.column = query->column;
+        api_query.where = (query->where == nullptr) ? "" : query->where;
+        api_query.schema = (query->schema == nullptr) ? "" : query->schema;
+        api_query.all_matches = query->all_matches != 0;
+        long long match_count = 0;
+        std::vector<csv_valence_field> fields;  // reused between matches
+        const bool success = corpus->corpus.query(words->words, api_query, [&](const std::size_t word, const std::size_t offset, const CsvReader::row_t &row) {
+            ++match_count;
+            if (callback == nullptr) {
+                return true;
+            }
+            fields.clear();
+            for (const CsvReader::field_t &field : row.fields) {
+                fields.push_back(csv_valence_field{field.view.data(), field.view.size(), field.escaped ? 1 : 0});
+            }
+            const csv_valence_match match{word, offset, row.bytes.data(), row.bytes.size(), fields.data(), fields.size()};
+            return callback(&match, user_data) != 0;
+        });
+        return success ? match_count : -1;
+    }
+    catch (const std::exception &e) {
+        Logger::error() << "query failed: " << e.what() << ".";
+        return -1;
+    }
+}
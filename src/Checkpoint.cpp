@@ -0,0 +1,179 @@
+#include "Checkpoint.hpp"
+#include "ColumnIndex.hpp"
+#include "CsvReader.hpp"
+#include "DiskManager.hpp"
+#include "Logger.hpp"
+#include "OutputWriter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+
+constexpr char state_magic[8] = {'C', 'S', 'V', 'V', 'S', 'T', 'A', '1'};
+constexpr std::size_t sample_size = 1 << 16;  // bytes hashed at each end of the processed part of the CSV file
+
+}  // namespace
+
+namespace Checkpoint {
+
+std::string state_filename(const std::string &filename_output)
+/*
+ * Return the path of the state file, e.g., "output.csv.state" for "output.csv".
+ */
+{
+    return filename_output + ".state";
+}
+
+std::uint64_t settings_hash(const ConsoleInput::console_args_t &args, const std::vector<std::string_view> &words)
+/*
+ * Return a hash of everything that decides which rows match, so changing any of it leads to a full rescan.
+ */
+{
+    // appending rows in another format would mix formats in one output, so the format counts too
+    std::string settings = std::to_string(args.word_column_idx) + '\n' + OutputWriter::format_name(args.output_format) + '\n' +
+                           args.where + '\n' + args.schema + '\n' +
+                           std::to_string(args.max_distance) + '\n' + (args.all_matches ? "all" : "first") + '\n' +
+                           (args.normalize.canonical ? "c" : "") + (args.normalize.compatibility ? "k" : "") +
+                           (args.normalize.fold_case ? "f" : "") + (args.normalize.strip_accents ? "a" : "") + '\n';
+    for (const std::string_view word : words) {
+        settings += word;
+        settings += '\n';
+    }
+    return ColumnIndex::hash_key(settings);
+}
+
+std::size_t complete_rows(const std::string_view data)
+/*
+ * Return the end of the last row that is followed by a newline.
+ * A row that is still being appended (without its newline) is left for the next run.
+ */
+{
+    const std::size_t newline = data.rfind('\n');
+    return (newline == std::string_view::npos) ? 0 : newline + 1;
+}
+
+header_t make_header(const std::string_view data, const std::size_t offset, const std::uint64_t settings_hash)
+/*
+ * Return the state of a run that processed "data" up to "offset".
+ * Hashing the entire prefix would cost as much as scanning it, so only both ends are hashed;
+ * appending rows never changes either of them, but rewriting the file almost always does.
+ */
+{
+    header_t header;
+    std::memcpy(header.magic, state_magic, sizeof(state_magic));
+    header.settings_hash = settings_hash;
+    header.offset = offset;
+    const std::size_t head = std::min(offset, sample_size);
+    const std::size_t tail = std::min(offset - head, sample_size);
+    header.head_hash = ColumnIndex::hash_key(data.substr(0, head));
+    header.tail_hash = ColumnIndex::hash_key(data.substr(offset - tail, tail));
+    header.output_size = 0;
+    header.found_count = 0;
+    return header;
+}
+
+bool resume(const ConsoleInput::console_args_t &args,
+            const std::string_view data,
+            const std::uint64_t settings_hash,
+            std::size_t &offset,
+            std::vector<std::size_t> &found)
+/*
+ * Read the state of the last run of this job, if "--incremental" is set.
+ * The run can only be resumed if the CSV file still begins with the bytes that were processed,
+ * the options and target words are the same, and the output CSV wasn't changed since.
+ *
+ * Return True if the run resumes at "offset" (with the indices of target words that were already found in "found"),
+ * False if the CSV has to be scanned from the beginning.
+ */
+{
+    const std::string filename_state = state_filename(args.filename_output);
+    if (!std::filesystem::exists(filename_state)) {
+        if (args.verbose) {
+            Logger::debug() << "no state file '" << filename_state << "' yet, scanning '" << args.filename_csv << "' from the beginning.";
+        }
+        return false;
+    }
+    const CsvReader::MappedFile file(filename_state);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::string_view state_data = file.data();
+    header_t header;
+    if (state_data.size() < sizeof(header_t)) {
+        Logger::warning() << "ignoring invalid state file '" << filename_state << "', scanning the CSV from the beginning.";
+        return false;
+    }
+    std::memcpy(&header, state_data.data(), sizeof(header_t));
+    if (std::memcmp(header.magic, state_magic, sizeof(state_magic)) != 0 ||
+        state_data.size() != sizeof(header_t) + header.found_count * sizeof(std::uint64_t)) {
+        Logger::warning() << "ignoring invalid state file '" << filename_state << "', scanning the CSV from the beginning.";
+        return false;
+    }
+    std::error_code error;
+    const std::uintmax_t output_size = std::filesystem::file_size(args.filename_output, error);
+    const char *reason = nullptr;
+    if (header.settings_hash != settings_hash) {
+        reason = "the target words or options changed";
+    }
+    else if (header.offset > data.size()) {
+        reason = "the CSV got shorter";
+    }
+    else if (const header_t current = make_header(data, header.offset, settings_hash);
+             current.head_hash != header.head_hash || current.tail_hash != header.tail_hash) {
+        reason = "the CSV was rewritten instead of appended to";
+    }
+    else if (error || output_size != header.output_size) {
+        reason = "the output CSV changed";
+    }
+    if (reason != nullptr) {
+        Logger::info() << "scanning '" << args.filename_csv << "' from the beginning, because " << reason
+                       << " since the last run.";
+        return false;
+    }
+    offset = header.offset;
+    found.resize(header.found_count);
+    for (std::size_t i = 0; i != found.size(); ++i) {
+        std::uint64_t word_idx;
+        std::memcpy(&word_idx, state_data.data() + sizeof(header_t) + i * sizeof(std::uint64_t), sizeof(word_idx));
+        found[i] = word_idx;
+    }
+    Logger::info() << "resuming '" << args.filename_csv << "' at byte offset '" << offset << "' ('"
+                   << (data.size() - offset) << "' new bytes), '" << found.size()
+                   << "' target words were found by earlier runs.";
+    return true;
+}
+
+bool save(const ConsoleInput::console_args_t &args, header_t header, const std::vector<std::size_t> &found)
+/*
+ * Save the state of this run (see "make_header()"), after the output CSV was written.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    std::error_code error;
+    header.output_size = std::filesystem::file_size(args.filename_output, error);
+    if (error) {
+        Logger::error() << "could not get the size of '" << args.filename_output << "'.";
+        return false;
+    }
+    header.found_count = found.size();
+    const std::string filename_state = state_filename(args.filename_output);
+    DiskManager::BufferedWriter writer(filename_state);
+    writer.write(std::string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+    for (const std::size_t word_idx : found) {
+        const auto value = static_cast<std::uint64_t>(word_idx);
+        writer.write(std::string_view(reinterpret_cast<const char *>(&value), sizeof(value)));
+    }
+    if (!writer.flush()) {
+        return false;
+    }
+    if (args.verbose) {
+        Logger::debug() << "saved state of '" << args.filename_csv << "' up to byte offset '" << header.offset
+                        << "' to '" << filename_state << "'.";
+    }
+    return true;
+}
+
+}  // namespace Checkpoint
@@ -0,0 +1,37 @@
+#pragma once
+
+// libraries
+#include "ConsoleInput.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace Checkpoint {
+
+// types
+struct header_t {
+    char magic[8];                // "CSVVSTA1", also guards against a different byte order
+    std::uint64_t settings_hash;  // hash of the target words and of the options that decide which rows match
+    std::uint64_t offset;         // end of the last processed row, the next run resumes there
+    std::uint64_t head_hash;      // hash of the beginning of the CSV file, up to "offset"
+    std::uint64_t tail_hash;      // hash of the bytes right before "offset"
+    std::uint64_t output_size;    // size of the output CSV file after the run, new matches are appended to it
+    std::uint64_t found_count;    // amount of found target words, whose indices follow the header
+};
+
+// prototypes
+std::string state_filename(const std::string &filename_output);
+std::uint64_t settings_hash(const ConsoleInput::console_args_t &args, const std::vector<std::string_view> &words);
+std::size_t complete_rows(const std::string_view data);
+header_t make_header(const std::string_view data, const std::size_t offset, const std::uint64_t settings_hash);
+bool resume(const ConsoleInput::console_args_t &args,
+            const std::string_view data,
+            const std::uint64_t settings_hash,
+            std::size_t &offset,
+            std::vector<std::size_t> &found);
+bool save(const ConsoleInput::console_args_t &args, header_t header, const std::vector<std::size_t> &found);
+
+}  // namespace Checkpoint
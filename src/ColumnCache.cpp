@@ -0,0 +1,421 @@
+#include "ColumnCache.hpp"
+#include "DiskManager.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr char cache_magic[8] = {'C', 'S', 'V', 'V', 'C', 'A', 'C', '2'};
+constexpr std::int64_t no_integer = std::numeric_limits<std::int64_t>::min();  // empty value in an integer column
+
+struct column_state_t {
+    Schema::type_t type = Schema::type_t::integer;  // narrowed to "real" and then "text" as values are seen
+    std::vector<std::int64_t> integers;
+    std::vector<double> reals;
+};
+
+struct string_hash {
+    using is_transparent = void;  // look up "std::string_view" without copying it into a "std::string"
+
+    std::size_t operator()(const std::string_view s) const
+    {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+std::size_t padded(const std::size_t size)
+{
+    return (size + 7) & ~std::size_t{7};
+}
+
+bool take_section(const std::size_t file_size, std::size_t &size, const std::uint64_t count, const std::size_t item_size)
+/*
+ * Check that a section of "count" items of "item_size" bytes fits into a cache of "file_size" bytes after its first "size" bytes,
+ * without overflowing, however large "count" is.
+ *
+ * Return True if it fits ("size" is then moved past the padded section), False if not.
+ */
+{
+    if (size > file_size || count > (file_size - size) / item_size) {
+        return false;
+    }
+    size += padded(static_cast<std::size_t>(count) * item_size);
+    return true;
+}
+
+void write_section(DiskManager::BufferedWriter &writer, const void *data, const std::size_t size)
+/*
+ * Write a section of the cache, padded with zeros to a multiple of 8 bytes.
+ */
+{
+    writer.write(std::string_view(static_cast<const char *>(data), size));
+    for (std::size_t i = size; i != padded(size); ++i) {
+        writer.put('\0');
+    }
+}
+
+void add_value(column_state_t &state, const std::string_view value)
+/*
+ * Append a value to a column that is still numeric, widening it from integers to reals
+ * (or giving up on it, once a value is not a number) as needed.
+ */
+{
+    if (value.empty()) {
+        if (state.type == Schema::type_t::integer) {
+            state.integers.push_back(no_integer);
+        }
+        else {
+            state.reals.push_back(std::numeric_limits<double>::quiet_NaN());
+        }
+        return;
+    }
+    std::int64_t integer;
+    if (Schema::parse_integer(value, integer) && integer != no_integer) {
+        if (state.type == Schema::type_t::integer) {
+            state.integers.push_back(integer);
+        }
+        else {
+            state.reals.push_back(static_cast<double>(integer));
+        }
+        return;
+    }
+    double real;
+    if (!Schema::parse_real(value, real)) {
+        state.type = Schema::type_t::text;
+        std::vector<std::int64_t>().swap(state.integers);
+        std::vector<double>().swap(state.reals);
+        return;
+    }
+    if (state.type == Schema::type_t::integer) {
+        state.type = Schema::type_t::real;
+        state.reals.reserve(state.integers.size() + 1);
+        for (const std::int64_t previous : state.integers) {
+            state.reals.push_back(previous == no_integer ? std::numeric_limits<double>::quiet_NaN() : static_cast<double>(previous));
+        }
+        std::vector<std::int64_t>().swap(state.integers);
+    }
+    state.reals.push_back(real);
+}
+
+}  // namespace
+
+namespace ColumnCache {
+
+std::string cache_filename(const std::string &filename_csv, const std::size_t column)
+/*
+ * Return the path of the sidecar cache file, e.g., "data.csv.1.cache" for column 1 of "data.csv".
+ */
+{
+    return filename_csv + "." + std::to_string(column) + ".cache";
+}
+
+bool build(const std::string &filename_csv, const std::size_t column, const bool verbose)
+/*
+ * Convert the CSV once into a columnar file that later runs map into memory instead of parsing the CSV.
+ * It holds the values of "column" as a dictionary (every distinct value once, plus a 4-byte key per row),
+ * every column whose values are all numbers as an array of numbers, and the byte offset of every row,
+ * so matching rows can be read from the CSV without parsing anything else.
+ *
+ * The file is a "header_t" followed by these sections, each padded to 8 bytes, so all of them can be used in place:
+ * 1. "column_t" for every column of the CSV header
+ * 2. "key_t" for every distinct key, sorted by hash
+ * 3. "std::uint64_t" byte offset of every row in the CSV, followed by the end of the CSV
+ * 4. "std::uint32_t" key of every row ("no_key" if its amount of columns is not equal to the header's)
+ * 5. "std::int64_t" or "double" value of every row, for each column that is not text
+ * 6. all distinct keys, back to back
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    const CsvReader::MappedFile file(filename_csv);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::string_view data = file.data();
+    CsvReader::Reader reader(data);
+    CsvReader::row_t row;
+    reader.next_row(row);
+    const std::size_t column_count = row.fields.size();
+    if (column >= column_count) {
+        Logger::error() << "the target column index '" << column
+                        << "' is larger than the total amount of columns '" << column_count
+                        << "', cannot build cache for '" << filename_csv << "'.";
+        return false;
+    }
+    std::vector<column_state_t> states(column_count);
+    std::unordered_map<std::string, std::uint32_t, string_hash, std::equal_to<>> key_ids;
+    std::vector<key_t> keys;
+    std::string key_bytes;
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::uint32_t> row_keys;
+    std::string buffer;
+    while (reader.next_row(row)) {
+        if (offsets.size() == Cache::no_key) {
+            Logger::error() << "'" << filename_csv << "' has too many rows to be cached.";
+            return false;
+        }
+        const auto row_idx = static_cast<std::uint32_t>(offsets.size());
+        offsets.push_back(static_cast<std::uint64_t>(row.bytes.data() - data.data()));
+        // the scan skips rows whose amount of columns is not equal to the header's, so they never match,
+        // and their values are left empty, so they can't change the type of a column either
+        const bool is_valid = row.fields.size() == column_count;
+        for (std::size_t i = 0; i != column_count; ++i) {
+            if (states[i].type != Schema::type_t::text) {
+                add_value(states[i], is_valid ? CsvReader::field_value(row.fields[i], buffer) : std::string_view());
+            }
+        }
+        if (!is_valid) {
+            row_keys.push_back(Cache::no_key);
+            continue;
+        }
+        const std::string_view value = CsvReader::field_value(row.fields[column], buffer);
+        auto itr = key_ids.find(value);
+        if (itr == key_ids.end()) {
+            const auto key_idx = static_cast<std::uint32_t>(keys.size());
+            keys.push_back(key_t{ColumnIndex::hash_key(value), key_bytes.size(), static_cast<std::uint32_t>(value.size()), row_idx});
+            key_bytes.append(value);
+            itr = key_ids.emplace(std::string(value), key_idx).first;
+        }
+        row_keys.push_back(itr->second);
+    }
+    const std::size_t row_count = row_keys.size();
+    offsets.push_back(data.size());
+    // sort keys by hash for binary search, and renumber the key of every row to match
+    std::vector<std::uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const std::uint32_t a, const std::uint32_t b) {
+        return keys[a].hash < keys[b].hash;
+    });
+    std::vector<key_t> sorted_keys(keys.size());
+    std::vector<std::uint32_t> renumbered(keys.size());
+    for (std::size_t i = 0; i != order.size(); ++i) {
+        sorted_keys[i] = keys[order[i]];
+        renumbered[order[i]] = static_cast<std::uint32_t>(i);
+    }
+    for (std::uint32_t &key : row_keys) {
+        if (key != Cache::no_key) {
+            key = renumbered[key];
+        }
+    }
+    std::vector<column_t> columns(column_count);
+    std::uint32_t stored = 0;
+    for (std::size_t i = 0; i != column_count; ++i) {
+        columns[i] = column_t{states[i].type, (states[i].type == Schema::type_t::text) ? 0 : stored++};
+    }
+    header_t header;
+    std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    if (!ColumnIndex::fingerprint(filename_csv, data, header.csv)) {
+        Logger::error() << "could not get the size of '" << filename_csv << "'.";
+        return false;
+    }
+    header.column = column;
+    header.row_count = row_count;
+    header.column_count = column_count;
+    header.key_count = sorted_keys.size();
+    header.key_bytes = key_bytes.size();
+    const std::string filename_cache = cache_filename(filename_csv, column);
+    DiskManager::BufferedWriter writer(filename_cache);
+    write_section(writer, &header, sizeof(header));
+    write_section(writer, columns.data(), columns.size() * sizeof(column_t));
+    write_section(writer, sorted_keys.data(), sorted_keys.size() * sizeof(key_t));
+    write_section(writer, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    write_section(writer, row_keys.data(), row_keys.size() * sizeof(std::uint32_t));
+    for (const column_state_t &state : states) {
+        if (state.type == Schema::type_t::integer) {
+            write_section(writer, state.integers.data(), state.integers.size() * sizeof(std::int64_t));
+        }
+        else if (state.type == Schema::type_t::real) {
+            write_section(writer, state.reals.data(), state.reals.size() * sizeof(double));
+        }
+    }
+    write_section(writer, key_bytes.data(), key_bytes.size());
+    if (!writer.flush()) {
+        return false;
+    }
+    Logger::info() << "cached '" << row_count << "' rows with '" << sorted_keys.size() << "' distinct words in column no. '"
+                   << column << "' and '" << stored << "' numeric columns of '" << filename_csv
+                   << "', see '" << filename_cache << "'.";
+    if (verbose) {
+        Logger::debug() << "cache takes '" << writer.bytes_written() << "' bytes, the CSV takes '" << data.size() << "' bytes.";
+    }
+    return true;
+}
+
+bool Cache::open(const std::string &filename_csv, const std::string_view data, const std::size_t column, const bool verbose)
+/*
+ * Map the cache of "column" into memory, if it exists and matches the current contents of the CSV.
+ *
+ * Return True if the cache can be used, False if it is missing, invalid or stale.
+ */
+{
+    const std::string filename_cache = cache_filename(filename_csv, column);
+    if (!std::filesystem::exists(filename_cache)) {
+        return false;
+    }
+    if (!this->file.emplace(filename_cache).is_open()) {
+        Logger::warning() << "could not open cache '" << filename_cache << "', reading the CSV instead.";
+        return false;
+    }
+    const std::string_view cache_data = this->file->data();
+    ColumnIndex::fingerprint_t current;
+    if (cache_data.size() < sizeof(header_t) || !ColumnIndex::fingerprint(filename_csv, data, current)) {
+        Logger::warning() << "ignoring invalid cache '" << filename_cache << "', reading the CSV instead.";
+        return false;
+    }
+    std::memcpy(&this->header, cache_data.data(), sizeof(header_t));
+    const header_t &header = this->header;
+    // the last byte of the magic is the version of the format
+    if (std::memcmp(header.magic, cache_magic, sizeof(cache_magic) - 1) == 0 &&
+        header.magic[sizeof(cache_magic) - 1] != cache_magic[sizeof(cache_magic) - 1]) {
+        Logger::warning() << "cache '" << filename_cache << "' was built by another version, reading the CSV instead. "
+                             "Please rebuild it using '--build-cache'.";
+        return false;
+    }
+    // sizes are checked one section at a time, so a damaged header never leads to reading past the end
+    std::size_t size = padded(sizeof(header_t));
+    bool is_valid = std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) == 0 &&
+                    header.column == column && header.column < header.column_count &&
+                    header.row_count < no_key && header.key_count < no_key &&
+                    take_section(cache_data.size(), size, header.column_count, sizeof(column_t));
+    std::size_t stored = 0;
+    if (is_valid) {
+        this->columns = reinterpret_cast<const column_t *>(cache_data.data() + padded(sizeof(header_t)));
+        for (std::size_t i = 0; i != header.column_count; ++i) {
+            if (this->columns[i].type != Schema::type_t::text) {
+                is_valid = is_valid && this->columns[i].values == stored++;
+            }
+        }
+        this->keys = reinterpret_cast<const key_t *>(cache_data.data() + size);
+        is_valid = is_valid && take_section(cache_data.size(), size, header.key_count, sizeof(key_t));
+    }
+    if (is_valid) {
+        this->offsets = reinterpret_cast<const std::uint64_t *>(cache_data.data() + size);
+        is_valid = take_section(cache_data.size(), size, header.row_count + 1, sizeof(std::uint64_t));
+    }
+    if (is_valid) {
+        this->row_keys = reinterpret_cast<const std::uint32_t *>(cache_data.data() + size);
+        is_valid = take_section(cache_data.size(), size, header.row_count, sizeof(std::uint32_t));
+    }
+    this->values = cache_data.data() + size;
+    // one section per stored column, so the size of all of them can't overflow either
+    for (std::size_t i = 0; i != stored && is_valid; ++i) {
+        is_valid = take_section(cache_data.size(), size, header.row_count, sizeof(std::uint64_t));
+    }
+    if (is_valid) {
+        this->key_bytes = cache_data.data() + size;
+        is_valid = take_section(cache_data.size(), size, header.key_bytes, 1) && cache_data.size() == size;
+    }
+    // every value that is used as an index or an offset is checked once, so the lookups don't have to
+    for (std::size_t i = 0; i != header.key_count && is_valid; ++i) {
+        const key_t &key = this->keys[i];
+        is_valid = key.offset <= header.key_bytes && key.size <= header.key_bytes - key.offset && key.first_row < header.row_count;
+    }
+    for (std::size_t row = 0; row != header.row_count && is_valid; ++row) {
+        is_valid = (this->row_keys[row] < header.key_count || this->row_keys[row] == no_key) &&
+                   this->offsets[row] <= this->offsets[row + 1];
+    }
+    is_valid = is_valid && this->offsets[header.row_count] == data.size();
+    if (!is_valid) {
+        Logger::warning() << "ignoring invalid cache '" << filename_cache << "', reading the CSV instead.";
+        return false;
+    }
+    if (header.csv != current) {
+        Logger::warning() << "cache '" << filename_cache << "' is out of date, reading the CSV instead. "
+                             "Please rebuild it using '--build-cache'.";
+        return false;
+    }
+    if (verbose) {
+        Logger::debug() << "using cache '" << filename_cache << "' with '" << header.row_count << "' rows and '"
+                        << header.key_count << "' distinct words.";
+    }
+    return true;
+}
+
+std::size_t Cache::rows() const
+{
+    return this->header.row_count;
+}
+
+std::size_t Cache::key_count() const
+{
+    return this->header.key_count;
+}
+
+std::size_t Cache::find(const std::string_view value) const
+/*
+ * Return the index of "value" among the distinct keys, or "npos" if no row has it.
+ */
+{
+    const std::uint64_t hash = ColumnIndex::hash_key(value);
+    const key_t *end = this->keys + this->header.key_count;
+    const key_t *itr = std::lower_bound(this->keys, end, hash, [](const key_t &key, const std::uint64_t value) {
+        return key.hash < value;
+    });
+    for (; itr != end && itr->hash == hash; ++itr) {
+        if (this->key(static_cast<std::size_t>(itr - this->keys)) == value) {
+            return static_cast<std::size_t>(itr - this->keys);
+        }
+    }
+    return npos;
+}
+
+std::string_view Cache::key(const std::size_t key_idx) const
+{
+    const key_t &key = this->keys[key_idx];
+    return std::string_view(this->key_bytes + key.offset, key.size);
+}
+
+std::size_t Cache::first_row(const std::size_t key_idx) const
+{
+    return this->keys[key_idx].first_row;
+}
+
+std::uint32_t Cache::row_key(const std::size_t row) const
+{
+    return this->row_keys[row];
+}
+
+std::size_t Cache::offset(const std::size_t row) const
+/*
+ * Return the byte offset of "row" in the CSV.
+ */
+{
+    return this->offsets[row];
+}
+
+bool Cache::is_numeric(const std::size_t column) const
+/*
+ * Return True if every value of "column" is stored in the cache as a number, False if it has to be read from the CSV.
+ */
+{
+    return column < this->header.column_count && this->columns[column].type != Schema::type_t::text;
+}
+
+bool Cache::number(const std::size_t row, const std::size_t column, double &value) const
+/*
+ * Read the value of a numeric column (see "is_numeric()").
+ *
+ * Return True if succeeded, False if the value is empty (or the row is invalid).
+ */
+{
+    const column_t &info = this->columns[column];
+    const char *position = this->values + (info.values * this->header.row_count + row) * sizeof(std::uint64_t);
+    if (info.type == Schema::type_t::integer) {
+        std::int64_t integer;
+        std::memcpy(&integer, position, sizeof(integer));
+        value = static_cast<double>(integer);
+        return integer != no_integer;
+    }
+    std::memcpy(&value, position, sizeof(value));
+    return !std::isnan(value);
+}
+
+}  // namespace ColumnCache
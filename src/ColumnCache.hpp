@@ -0,0 +1,70 @@
+#pragma once
+
+// libraries
+#include "ColumnIndex.hpp"
+#include "CsvReader.hpp"
+#include "Schema.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// custom namespace
+namespace ColumnCache {
+
+// types
+struct header_t {
+    char magic[8];                   // "CSVVCAC2", also guards against a different byte order
+    ColumnIndex::fingerprint_t csv;  // identifies the contents of the CSV file that was cached
+    std::uint64_t column;            // key column, whose values are dictionary-encoded
+    std::uint64_t row_count;         // rows after the CSV header
+    std::uint64_t column_count;      // columns in the CSV header
+    std::uint64_t key_count;         // distinct values of the key column
+    std::uint64_t key_bytes;         // size of all distinct values, back to back
+};
+
+struct column_t {
+    Schema::type_t type;   // text is not stored, it's read from the CSV when needed
+    std::uint32_t values;  // index of the column among the stored (non-text) columns
+};
+
+struct key_t {
+    std::uint64_t hash;       // "ColumnIndex::hash_key()" of the value
+    std::uint64_t offset;     // where the value begins among the key bytes
+    std::uint32_t size;       // size of the value in bytes
+    std::uint32_t first_row;  // first row that contains the value
+};
+
+class Cache {
+  public:
+    static constexpr std::uint32_t no_key = static_cast<std::uint32_t>(-1);
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    bool open(const std::string &filename_csv, const std::string_view data, const std::size_t column, const bool verbose);
+    std::size_t rows() const;
+    std::size_t key_count() const;
+    std::size_t find(const std::string_view value) const;
+    std::string_view key(const std::size_t key_idx) const;
+    std::size_t first_row(const std::size_t key_idx) const;
+    std::uint32_t row_key(const std::size_t row) const;
+    std::size_t offset(const std::size_t row) const;
+    bool is_numeric(const std::size_t column) const;
+    bool number(const std::size_t row, const std::size_t column, double &value) const;
+
+  private:
+    std::optional<CsvReader::MappedFile> file;
+    header_t header;
+    const column_t *columns = nullptr;
+    const key_t *keys = nullptr;
+    const std::uint64_t *offsets = nullptr;
+    const std::uint32_t *row_keys = nullptr;
+    const char *values = nullptr;  // first stored column, each takes "row_count" 8-byte values
+    const char *key_bytes = nullptr;
+};
+
+// prototypes
+std::string cache_filename(const std::string &filename_csv, const std::size_t column);
+bool build(const std::string &filename_csv, const std::size_t column, const bool verbose);
+
+}  // namespace ColumnCache
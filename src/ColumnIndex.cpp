@@ -0,0 +1,270 @@
+#include "ColumnIndex.hpp"
+#include "CsvReader.hpp"
+#include "DiskManager.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <sys/stat.h>
+#include <thread>
+
+namespace {
+
+constexpr char index_magic[8] = {'C', 'S', 'V', 'V', 'I', 'D', 'X', '2'};
+constexpr std::size_t sample_size = 1 << 16;  // bytes hashed at each end of the CSV file
+
+std::uint64_t fnv1a(const std::string_view s, std::uint64_t hash = 14695981039346656037ull)
+/*
+ * FNV-1a, used instead of "std::hash" because the result is written to disk and must not change between builds.
+ */
+{
+    for (const char c : s) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+}  // namespace
+
+namespace ColumnIndex {
+
+std::string index_filename(const std::string &filename_csv, const std::size_t column)
+/*
+ * Return the path of the sidecar index file, e.g., "data.csv.1.idx" for column 1 of "data.csv".
+ */
+{
+    return filename_csv + "." + std::to_string(column) + ".idx";
+}
+
+std::uint64_t hash_key(const std::string_view key)
+{
+    return fnv1a(key);
+}
+
+bool fingerprint(const std::string &filename_csv, const std::string_view data, fingerprint_t &fingerprint)
+/*
+ * Fill in "fingerprint", which identifies the current contents of the CSV file.
+ * Hashing the entire file would cost as much as scanning it, so only both ends are hashed;
+ * together with the size and modification time, this catches appends and rewrites.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    struct stat st;
+    if (stat(filename_csv.c_str(), &st) == -1) {
+        return false;
+    }
+    fingerprint.csv_size = static_cast<std::uint64_t>(st.st_size);
+    fingerprint.csv_mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    const std::size_t head = std::min(data.size(), sample_size);
+    const std::size_t tail = std::min(data.size() - head, sample_size);
+    fingerprint.csv_hash = fnv1a(data.substr(data.size() - tail), fnv1a(data.substr(0, head)));
+    return true;
+}
+
+bool build(const std::string &filename_csv, const std::size_t column, const std::size_t threads, const bool verbose)
+/*
+ * Scan the CSV once and save a table of (word hash, row offset) pairs for "column", sorted by hash.
+ * Later runs can then look up each target word with a binary search instead of scanning the CSV.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    const CsvReader::MappedFile file(filename_csv);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::string_view data = file.data();
+    CsvReader::Reader reader(data);
+    CsvReader::row_t header_row;
+    reader.next_row(header_row);
+    if (column >= header_row.fields.size()) {
+        Logger::error() << "the target column index '" << column
+                        << "' is larger than the total amount of columns '" << header_row.fields.size()
+                        << "', cannot build index for '" << filename_csv << "'.";
+        return false;
+    }
+    const std::size_t column_count = header_row.fields.size();
+    // every chunk collects its own entries, they are joined afterwards
+    const std::vector<std::size_t> bounds = CsvReader::split_rows(data, reader.offset(), threads);
+    std::vector<std::vector<entry_t>> chunk_entries(bounds.size() - 1);
+    const auto index_chunk = [&](const std::size_t k) {
+        CsvReader::Reader chunk_reader(data, bounds[k]);
+        CsvReader::row_t row;
+        std::string key_buffer;
+        while (chunk_reader.next_row(row)) {
+            const auto row_offset = static_cast<std::size_t>(row.bytes.data() - data.data());
+            if (row_offset >= bounds[k + 1]) {
+                break;
+            }
+            // the scan skips rows whose amount of columns is not equal to the header's, so they are left out
+            if (row.fields.size() != column_count) {
+                continue;
+            }
+            chunk_entries[k].push_back(entry_t{hash_key(CsvReader::field_value(row.fields[column], key_buffer)), row_offset});
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t k = 0; k != chunk_entries.size(); ++k) {
+        workers.emplace_back(index_chunk, k);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    std::vector<entry_t> entries;
+    for (const auto &chunk : chunk_entries) {
+        entries.insert(entries.end(), chunk.begin(), chunk.end());
+    }
+    // sorting by offset within the same hash keeps the first row of every word in front
+    std::sort(entries.begin(), entries.end(), [](const entry_t &a, const entry_t &b) {
+        return (a.hash != b.hash) ? a.hash < b.hash : a.offset < b.offset;
+    });
+    header_t header;
+    std::memcpy(header.magic, index_magic, sizeof(index_magic));
+    if (!fingerprint(filename_csv, data, header.csv)) {
+        Logger::error() << "could not get the size of '" << filename_csv << "'.";
+        return false;
+    }
+    header.column = column;
+    header.entry_count = entries.size();
+    const std::string filename_index = index_filename(filename_csv, column);
+    DiskManager::BufferedWriter writer(filename_index);
+    writer.write(std::string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+    writer.write(std::string_view(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(entry_t)));
+    if (!writer.flush()) {
+        return false;
+    }
+    Logger::info() << "indexed '" << entries.size() << "' rows of column no. '" << column
+                   << "' in '" << filename_csv << "', see '" << filename_index << "'.";
+    if (verbose) {
+        Logger::debug() << "index takes '" << writer.bytes_written() << "' bytes.";
+    }
+    return true;
+}
+
+bool find_rows(const std::string_view data,
+               const entry_t *entries,
+               const entry_t *entries_end,
+               const std::size_t column,
+               const std::size_t column_count,
+               const WordMatcher::Matcher &matcher,
+               const Query::Predicate &where,
+               const bool all_matches,
+               std::vector<std::pair<std::size_t, std::size_t>> &matches)
+/*
+ * Look up the exact target words of "matcher" in the sorted entries of an index of "column" of "data".
+ * Each candidate row is re-read and compared, so hash collisions never produce false matches.
+ * Candidates are sorted by offset, so the first one that also passes "where" is the first match in the CSV;
+ * without "all_matches", only that one is kept for every target word.
+ *
+ * The matches are stored in "matches" as (row offset, target word), sorted by offset.
+ *
+ * Return True if succeeded, False if a candidate's offset is past the end of "data" (the index is stale).
+ */
+{
+    matches.clear();
+    CsvReader::row_t row;
+    std::string key_buffer;
+    std::string where_buffer;
+    for (std::size_t word_idx = 0; word_idx != matcher.size(); ++word_idx) {
+        const std::uint64_t hash = hash_key(matcher.word(word_idx));
+        const entry_t *itr = std::lower_bound(entries, entries_end, hash, [](const entry_t &entry, const std::uint64_t value) {
+            return entry.hash < value;
+        });
+        for (; itr != entries_end && itr->hash == hash; ++itr) {
+            if (itr->offset >= data.size()) {
+                return false;
+            }
+            CsvReader::Reader row_reader(data, itr->offset);
+            row_reader.next_row(row);
+            // invalid rows are never indexed, but a candidate is re-read anyway, so it is checked like the scan does
+            if (row.fields.size() != column_count ||
+                CsvReader::field_value(row.fields[column], key_buffer) != matcher.word(word_idx) ||
+                !where.matches(row, where_buffer)) {
+                continue;
+            }
+            matches.emplace_back(itr->offset, word_idx);
+            if (!all_matches) {
+                break;
+            }
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    return true;
+}
+
+bool lookup(const std::string &filename_csv,
+            const std::string_view data,
+            const std::size_t column,
+            const WordMatcher::Matcher &matcher,
+            const Query::Predicate &where,
+            std::vector<std::size_t> &first_rows,
+            const bool verbose)
+/*
+ * Find the first matching row of every target word using the index of "column", see "find_rows()".
+ *
+ * Return True if the index was used, False if it is missing or stale (the caller has to scan the CSV instead).
+ */
+{
+    const std::string filename_index = index_filename(filename_csv, column);
+    if (!std::filesystem::exists(filename_index)) {
+        return false;
+    }
+    const CsvReader::MappedFile file(filename_index);
+    if (!file.is_open()) {
+        Logger::warning() << "could not open index '" << filename_index << "', scanning the CSV instead.";
+        return false;
+    }
+    const std::string_view index_data = file.data();
+    header_t header;
+    fingerprint_t current;
+    if (index_data.size() < sizeof(header_t) || !fingerprint(filename_csv, data, current)) {
+        Logger::warning() << "ignoring invalid index '" << filename_index << "', scanning the CSV instead.";
+        return false;
+    }
+    std::memcpy(&header, index_data.data(), sizeof(header));
+    // the last byte of the magic is the version of the format
+    if (std::memcmp(header.magic, index_magic, sizeof(index_magic) - 1) == 0 &&
+        header.magic[sizeof(index_magic) - 1] != index_magic[sizeof(index_magic) - 1]) {
+        Logger::warning() << "index '" << filename_index << "' was built by another version, scanning the CSV instead. "
+                             "Please rebuild it using '--build-index'.";
+        return false;
+    }
+    const bool is_valid = std::memcmp(header.magic, index_magic, sizeof(index_magic)) == 0 &&
+                          header.column == column &&
+                          index_data.size() == sizeof(header_t) + header.entry_count * sizeof(entry_t);
+    if (!is_valid) {
+        Logger::warning() << "ignoring invalid index '" << filename_index << "', scanning the CSV instead.";
+        return false;
+    }
+    if (header.csv != current) {
+        Logger::warning() << "index '" << filename_index << "' is out of date, scanning the CSV instead. "
+                             "Please rebuild it using '--build-index'.";
+        return false;
+    }
+    if (verbose) {
+        Logger::debug() << "using index '" << filename_index << "' with '" << header.entry_count << "' rows.";
+    }
+    // the file was written by "build()", so the entries are suitably aligned right after the header
+    const auto *entries = reinterpret_cast<const entry_t *>(index_data.data() + sizeof(header_t));
+    const entry_t *entries_end = entries + header.entry_count;
+    first_rows.assign(matcher.size(), WordMatcher::Matcher::npos);
+    CsvReader::row_t row;
+    CsvReader::Reader header_reader(data);
+    header_reader.next_row(row);
+    std::vector<std::pair<std::size_t, std::size_t>> matches;
+    // the fingerprint only samples the CSV, so an offset can still be past its end
+    if (!find_rows(data, entries, entries_end, column, row.fields.size(), matcher, where, false, matches)) {
+        Logger::warning() << "index '" << filename_index << "' is out of date, scanning the CSV instead. "
+                             "Please rebuild it using '--build-index'.";
+        first_rows.clear();
+        return false;
+    }
+    for (const auto &[offset, word_idx] : matches) {
+        first_rows[word_idx] = offset;
+    }
+    return true;
+}
+
+}  // namespace ColumnIndex
@@ -0,0 +1,59 @@
+#pragma once
+
+// libraries
+#include "Query.hpp"
+#include "WordMatcher.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// custom namespace
+namespace ColumnIndex {
+
+// types
+struct fingerprint_t {
+    std::uint64_t csv_size;  // size of the CSV file in bytes
+    std::int64_t csv_mtime;  // last modification time of the CSV file, in nanoseconds
+    std::uint64_t csv_hash;  // hash of the beginning and the end of the CSV file
+
+    bool operator==(const fingerprint_t &) const = default;
+};
+
+struct header_t {
+    char magic[8];              // "CSVVIDX2", also guards against a different byte order
+    fingerprint_t csv;          // identifies the contents of the CSV file that was indexed
+    std::uint64_t column;       // column whose words are indexed
+    std::uint64_t entry_count;  // amount of "entry_t" that follow the header
+};
+
+struct entry_t {
+    std::uint64_t hash;    // hash of the word in the indexed column
+    std::uint64_t offset;  // byte offset of the row in the CSV file
+};
+
+// prototypes
+std::string index_filename(const std::string &filename_csv, const std::size_t column);
+std::uint64_t hash_key(const std::string_view key);
+bool fingerprint(const std::string &filename_csv, const std::string_view data, fingerprint_t &fingerprint);
+bool build(const std::string &filename_csv, const std::size_t column, const std::size_t threads, const bool verbose);
+bool find_rows(const std::string_view data,
+               const entry_t *entries,
+               const entry_t *entries_end,
+               const std::size_t column,
+               const std::size_t column_count,
+               const WordMatcher::Matcher &matcher,
+               const Query::Predicate &where,
+               const bool all_matches,
+               std::vector<std::pair<std::size_t, std::size_t>> &matches);
+bool lookup(const std::string &filename_csv,
+            const std::string_view data,
+            const std::size_t column,
+            const WordMatcher::Matcher &matcher,
+            const Query::Predicate &where,
+            std::vector<std::size_t> &first_rows,
+            const bool verbose);
+
+}  // namespace ColumnIndex
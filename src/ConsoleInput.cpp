@@ -1,6 +1,13 @@
 #include "ConsoleInput.hpp"
+#include "Aggregate.hpp"
 #include "DiskManager.hpp"
+#include "InputStream.hpp"
+#include "Logger.hpp"
+#include "Normalizer.hpp"
+#include "Query.hpp"
+#include "Schema.hpp"
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -33,6 +40,16 @@ class ArgsHelper {
         this->vec_end = this->args_vec.end();
     }
 
+    ArgsHelper(const vec_opts_t &args)
+    /*
+     * Class constructor, for arguments that didn't come from the commandline (e.g., a line of the jobs file).
+     */
+    {
+        this->args_vec = args;
+        this->vec_begin = this->args_vec.begin();
+        this->vec_end = this->args_vec.end();
+    }
+
     bool check_if_exists(const std::string &name) const
     /*
      * Check if a single argument exists.
@@ -79,8 +96,8 @@ class ArgsHelper {
         if (itr != vec_end && ++itr != vec_end) {
             return *itr;
         }
-        std::cerr << "ERROR: argument '" << name << "' doesn't have a value.\n"
-                  << "Please enter '" << name << " \"VALUE\"'.\n";
+        Logger::error() << "argument '" << name << "' doesn't have a value. "
+                        << "Please enter '" << name << " \"VALUE\"'.";
         return this->empty_string;
     }
 };
@@ -88,25 +105,18 @@ class ArgsHelper {
 bool string_to_long_long(const std::string &s, long long &i)
 {
     /*
-     * Convert string "s" to long long "i".
+     * Convert string "s" to long long "i", using the same parser as numeric columns.
      *
      * Return True if succeeded, False if failed.
      */
-    bool success = false;
-    // convert to int
-    try {
-        i = std::stol(s);
-        success = true;
-    }
-    catch (std::invalid_argument const &e) {
-        std::cerr << "ERROR: invalid number (tried to convert '"
-                  << s << "' to long long).\n";
-    }
-    catch (std::out_of_range const &e) {
-        std::cerr << "ERROR: out of integer range (tried to convert '"
-                  << s << "' to long long).\n";
+    std::int64_t number;
+    if (!Schema::parse_integer(s, number)) {
+        Logger::error() << "invalid or out of range number (tried to convert '"
+                        << s << "' to long long).";
+        return false;
     }
-    return success;
+    i = static_cast<long long>(number);
+    return true;
 }
 
 namespace ConsoleInput {
@@ -117,7 +127,7 @@ void print_help(const char *program_name, const console_args_t &args)
      */
     std::cout << "usage: "
               << program_name
-              << " [-h | --help] [--words <filename>] [--csv <filename>] [--output <filename>] [--column <integer>] [-v | --verbose]\n\n"
+              << " [-h | --help] [--words <filename>] [--csv <filename>] [--output <filename>] [--format <name>] [--column <integer>] [--rejects <filename>] [--where <expression>] [--schema <list>] [--normalize <list>] [--max-distance <integer>] [--all-matches] [--aggregate <list>] [--incremental] [--jobs <filename>] [--threads <integer>] [--read-ahead] [--build-index] [--build-cache] [--serve] [--socket <filename>] [--stats] [--stats-json <filename>] [--log-level <level>] [-v | --verbose]\n\n"
                  "options:\n"
                  "  -h | --help                 print this help message\n"
                  "  --words <filename>          target list of newline-separated target words (default: \""
@@ -126,38 +136,55 @@ void print_help(const char *program_name, const console_args_t &args)
               << args.filename_csv << "\")\n"
               << "  --output <filename>         small output CSV with target words only (default: \""
               << args.filename_output << "\")\n"
+              << "  --format <name>             how matching rows are saved: raw (as they appear in the big input CSV), csv, tsv, jsonl or binary (default: \""
+              << OutputWriter::format_name(args.output_format) << "\")\n"
               << "  --column <integer>          column in big input CSV that contains target words (default: \""
               << args.word_column_idx << "\")\n"
-              << "  -v | --verbose              print extremely verbose messages\n";
+              << "  --rejects <filename>        save rows whose amount of columns is not equal to the header's, with their line number and byte offset\n"
+              << "  --where <expression>        keep only rows that pass a filter, e.g., \"PoS IN ('noun', 'verb') AND NOT #3 = '' AND Zipf > 3\"\n"
+              << "  --schema <list>             types of columns compared by '--where', instead of guessing them from the first rows, e.g., \"Freq:integer, Zipf:real, #0:text\"\n"
+              << "  --normalize <list>          compare words after normalizing them, comma-separated: nfc, nfkc, case, accents (e.g., \"case,accents\")\n"
+              << "  --max-distance <integer>    also match words within this many edits of a target word, the closest one wins (default: \""
+              << args.max_distance << "\")\n"
+              << "  --all-matches               save every matching row, instead of only the first one of each target word\n"
+              << "  --aggregate <list>          save totals per target word instead of rows, e.g., \"count, sum(Freq), mean(Freq), min(#2), max(#2)\"\n"
+              << "  --incremental               only read rows appended since the last run, and append new matches to the output CSV\n"
+              << "  --jobs <filename>           run every job listed in a file, one per line (e.g., '--csv data.csv --words words.txt')\n"
+              << "  --threads <integer>         amount of threads that scan the big input CSV in parallel (default: \""
+              << args.threads << "\")\n"
+              << "  --read-ahead                read the big input CSV with several reads in flight instead of mapping it, for network or cold storage\n"
+              << "  --build-index               save an index of the column next to the big input CSV, which makes later runs skip the scan\n"
+              << "  --build-cache               save a columnar cache of the big input CSV next to it, which makes later runs read only matching rows\n"
+              << "  --serve                     load the big input CSV of every job once and answer queries from stdin until it's closed\n"
+              << "  --socket <filename>         answer '--serve' queries on this Unix domain socket instead, using '--threads' workers\n"
+              << "  --stats                     print time spent in each phase and counters (rows, bytes, matches) at exit\n"
+              << "  --stats-json <filename>     save time spent in each phase and counters as JSON at exit\n"
+              << "  --log-level <level>         print only messages of this level or above: debug, ok, info, warning, error (default: \"ok\")\n"
+              << "  -v | --verbose              print extremely verbose messages (same as '--log-level debug')\n";
 }
 
-bool parse_args(console_args_t &args)
+bool parse_job_args(const ArgsHelper &args_helper, console_args_t &args)
 {
     /*
-     * Read filenames from commandline arguments, then check if they exist.
+     * Read filenames and column of a single job, then check if the files exist.
      *
      * Return True if everything worked as expected, False if failed.
      */
-    const ArgsHelper args_helper(args.argc, args.argv);
-    if (args_helper.check_if_exists("-h", "--help")) {
-        print_help(args.argv[0], args);
-        return false;
-    }
     // --- words.txt ---
     // check for "--words", but use "words.txt" as fallback
     if (args_helper.check_if_exists("--words")) {
         args.filename_words = args_helper.get_keyword_pair("--words");
         if (args.filename_words.empty()) {
-            std::cerr << "ERROR: please provide path to the words file "
-                         "(i.e., a file containing individual words, with each "
-                         "of them placed on a newline).\n";
+            Logger::error() << "please provide path to the words file "
+                               "(i.e., a file containing individual words, with each "
+                               "of them placed on a newline).";
             return false;
         }
     }
-    // file doesn't exist
-    if (!std::filesystem::exists(args.filename_words)) {
-        std::cerr << "FATAL ERROR: words file doesn't exist: '" << args.filename_words
-                  << "'. Please create a list of newline-separated words.\n";
+    // file doesn't exist (building an index or a cache, or serving queries, doesn't need any words)
+    if (!args.build_index && !args.build_cache && !args.serve && !std::filesystem::exists(args.filename_words)) {
+        Logger::fatal() << "words file doesn't exist: '" << args.filename_words
+                        << "'. Please create a list of newline-separated words.";
         exit(EXIT_FAILURE);
     }
     // --- data.csv ---
@@ -165,59 +192,350 @@ bool parse_args(console_args_t &args)
     if (args_helper.check_if_exists("--csv")) {
         args.filename_csv = args_helper.get_keyword_pair("--csv");
         if (args.filename_csv.empty()) {
-            std::cerr << "ERROR: please provide a path to the input CSV file "
-                         "(e.g., 'data.csv').\n";
+            Logger::error() << "please provide a path to the input CSV file "
+                               "(e.g., 'data.csv').";
             return false;
         }
     }
     if (!std::filesystem::exists(args.filename_csv)) {
-        std::cerr << "FATAL ERROR: big CSV file doesn't exist: '" << args.filename_csv
-                  << "'. Please provide a path to the input CSV file that contains "
-                     "words and their data.\n";
+        Logger::fatal() << "big CSV file doesn't exist: '" << args.filename_csv
+                        << "'. Please provide a path to the input CSV file that contains "
+                           "words and their data.";
         exit(EXIT_FAILURE);
     }
+    // compressed CSV files are decompressed while they are read, but they can't be indexed
+    const InputStream::format_t format = InputStream::detect_format(args.filename_csv);
+    if (!InputStream::is_supported(format)) {
+        Logger::error() << "'" << args.filename_csv << "' is " << InputStream::format_name(format)
+                        << "-compressed, but csv_valence was built without " << InputStream::format_name(format)
+                        << " support. Please decompress it first.";
+        return false;
+    }
+    if ((args.build_index || args.build_cache) && format != InputStream::format_t::plain) {
+        Logger::error() << "cannot build " << (args.build_index ? "an index" : "a cache") << " of '" << args.filename_csv
+                        << "', because it is compressed. Please decompress it first.";
+        return false;
+    }
     // --- output.csv ---
     // check for "--output", but use "output.csv" as fallback
     if (args_helper.check_if_exists("--output")) {
         args.filename_output = args_helper.get_keyword_pair("--output");
         if (args.filename_output.empty()) {
-            std::cerr << "ERROR: please provide a path to the output CSV file "
-                         "(e.g., 'output.csv').\n";
+            Logger::error() << "please provide a path to the output CSV file "
+                               "(e.g., 'output.csv').";
             return false;
         }
     }
-    if (!std::filesystem::exists(args.filename_output)) {
-        std::cout << "INFO: output CSV file doesn't exist, creating now: '"
-                  << args.filename_output
-                  << "'.\n";
-        DiskManager::create_empty_file(args.filename_output);
+    if (!args.build_index && !args.build_cache && !args.serve && !std::filesystem::exists(args.filename_output)) {
+        Logger::info() << "output CSV file doesn't exist, creating now: '"
+                       << args.filename_output
+                       << "'.";
+        if (!DiskManager::create_empty_file(args.filename_output)) {
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (args_helper.check_if_exists("--format")) {
+        const std::string &temp = args_helper.get_keyword_pair("--format");
+        if (!OutputWriter::parse_format(temp, args.output_format)) {
+            Logger::error() << "please provide one of 'raw', 'csv', 'tsv', 'jsonl' or 'binary' "
+                               "to '--format' (e.g., \"jsonl\").";
+            return false;
+        }
+    }
+    if (args_helper.check_if_exists("--rejects")) {
+        args.filename_rejects = args_helper.get_keyword_pair("--rejects");
+        if (args.filename_rejects.empty()) {
+            Logger::error() << "please provide a path to the rejects CSV file "
+                               "(e.g., 'rejects.csv').";
+            return false;
+        }
     }
     if (args_helper.check_if_exists("--column")) {
         std::string temp = args_helper.get_keyword_pair("--column");
         if (temp.empty()) {
-            std::cerr << "ERROR: no integer was provided to a column (default: \""
-                      << args.word_column_idx
-                      << "\"). Please provide a number.\n";
+            Logger::error() << "no integer was provided to a column (default: \""
+                            << args.word_column_idx
+                            << "\"). Please provide a number.";
             return false;
         }
         // convert string to long long
         long long temp_num;
         if (!string_to_long_long(temp, temp_num)) {
-            std::cerr << "ERROR: please provide a valid integer to a column "
-                         "(e.g., \"1\").\n";
+            Logger::error() << "please provide a valid integer to a column "
+                               "(e.g., \"1\").";
             return false;
         }
         if (temp_num < 0) {
-            std::cerr << "ERROR: please provide column integers equal to 0 or above "
-                         "(e.g., \"1\").\n";
+            Logger::error() << "please provide column integers equal to 0 or above "
+                               "(e.g., \"1\").";
             return false;
         }
         // cast long long to unsigned long
         args.word_column_idx = static_cast<std::size_t>(temp_num);
     }
+    if (args_helper.check_if_exists("--where")) {
+        args.where = args_helper.get_keyword_pair("--where");
+        // columns are resolved later, once the header is read; only the syntax is checked now
+        if (args.where.empty() || !Query::Predicate().parse(args.where)) {
+            Logger::error() << "please provide a valid filter to '--where' "
+                               "(e.g., \"PoS = 'noun'\").";
+            return false;
+        }
+    }
+    if (args_helper.check_if_exists("--schema")) {
+        args.schema = args_helper.get_keyword_pair("--schema");
+        // columns are resolved later, once the header is read; only the syntax is checked now
+        std::vector<Schema::entry_t> entries;
+        if (args.schema.empty() || !Schema::parse(args.schema, entries)) {
+            Logger::error() << "please provide a comma-separated list of column types to '--schema' "
+                               "(e.g., \"Freq:integer, Zipf:real\").";
+            return false;
+        }
+    }
+    if (args_helper.check_if_exists("--normalize")) {
+        const std::string &temp = args_helper.get_keyword_pair("--normalize");
+        if (!Normalizer::parse_options(temp, args.normalize)) {
+            Logger::error() << "please provide a comma-separated list of 'nfc', 'nfkc', 'case' or 'accents' "
+                               "to '--normalize' (e.g., \"case,accents\").";
+            return false;
+        }
+    }
+    if (args_helper.check_if_exists("--max-distance")) {
+        std::string temp = args_helper.get_keyword_pair("--max-distance");
+        if (temp.empty()) {
+            Logger::error() << "no integer was provided to max distance (default: \""
+                            << args.max_distance
+                            << "\"). Please provide a number.";
+            return false;
+        }
+        // convert string to long long
+        long long temp_num;
+        if (!string_to_long_long(temp, temp_num)) {
+            Logger::error() << "please provide a valid integer to max distance "
+                               "(e.g., \"1\").";
+            return false;
+        }
+        if (temp_num < 0) {
+            Logger::error() << "please provide max distance integers equal to 0 or above "
+                               "(e.g., \"1\").";
+            return false;
+        }
+        // cast long long to unsigned long
+        args.max_distance = static_cast<std::size_t>(temp_num);
+    }
+    if (args_helper.check_if_exists("--all-matches")) {
+        args.all_matches = true;
+    }
+    if (args_helper.check_if_exists("--aggregate")) {
+        args.aggregate = args_helper.get_keyword_pair("--aggregate");
+        // columns are resolved later, once the header is read; only the syntax is checked now
+        if (args.aggregate.empty() || !Aggregate::Table().parse(args.aggregate)) {
+            Logger::error() << "please provide a comma-separated list of aggregates to '--aggregate' "
+                               "(e.g., \"count, sum(Freq)\").";
+            return false;
+        }
+    }
+    if (args.all_matches && !args.aggregate.empty()) {
+        Logger::error() << "'--all-matches' and '--aggregate' cannot be combined, "
+                           "because '--aggregate' saves totals instead of rows.";
+        return false;
+    }
+    if (args_helper.check_if_exists("--incremental")) {
+        args.incremental = true;
+    }
+    if (args.incremental && !args.aggregate.empty()) {
+        Logger::error() << "'--incremental' and '--aggregate' cannot be combined, "
+                           "because totals can't be appended to.";
+        return false;
+    }
+    if (args.incremental && format != InputStream::format_t::plain) {
+        Logger::error() << "cannot read only new rows of '" << args.filename_csv
+                        << "', because it is compressed. Please decompress it first.";
+        return false;
+    }
+    return true;
+}
+
+bool parse_run_args(const ArgsHelper &args_helper, console_args_t &args)
+{
+    /*
+     * Read options that apply to the entire run, rather than to a single job.
+     *
+     * Return True if everything worked as expected, False if failed.
+     */
+    if (args_helper.check_if_exists("--threads")) {
+        std::string temp = args_helper.get_keyword_pair("--threads");
+        if (temp.empty()) {
+            Logger::error() << "no integer was provided to threads (default: \""
+                            << args.threads
+                            << "\"). Please provide a number.";
+            return false;
+        }
+        // convert string to long long
+        long long temp_num;
+        if (!string_to_long_long(temp, temp_num)) {
+            Logger::error() << "please provide a valid integer to threads "
+                               "(e.g., \"4\").";
+            return false;
+        }
+        if (temp_num < 1) {
+            Logger::error() << "please provide thread integers equal to 1 or above "
+                               "(e.g., \"4\").";
+            return false;
+        }
+        // cast long long to unsigned long
+        args.threads = static_cast<std::size_t>(temp_num);
+    }
+    if (args_helper.check_if_exists("--read-ahead")) {
+        args.read_ahead = true;
+    }
+    if (args_helper.check_if_exists("--build-index")) {
+        args.build_index = true;
+    }
+    if (args_helper.check_if_exists("--build-cache")) {
+        args.build_cache = true;
+    }
+    if (args_helper.check_if_exists("--serve")) {
+        args.serve = true;
+    }
+    if (args_helper.check_if_exists("--socket")) {
+        args.filename_socket = args_helper.get_keyword_pair("--socket");
+        if (args.filename_socket.empty()) {
+            Logger::error() << "please provide a path to the socket "
+                               "(e.g., 'csv_valence.sock').";
+            return false;
+        }
+        if (!args.serve) {
+            Logger::error() << "'--socket' only applies to '--serve'.";
+            return false;
+        }
+    }
+    if (args.serve && (args.build_index || args.build_cache)) {
+        Logger::error() << "'--serve' cannot be combined with '--build-index' or '--build-cache'.";
+        return false;
+    }
+    if (args_helper.check_if_exists("--stats")) {
+        args.stats = true;
+    }
+    if (args_helper.check_if_exists("--stats-json")) {
+        args.filename_stats = args_helper.get_keyword_pair("--stats-json");
+        if (args.filename_stats.empty()) {
+            Logger::error() << "please provide a path to the stats file "
+                               "(e.g., 'stats.json').";
+            return false;
+        }
+    }
+    if (args_helper.check_if_exists("--log-level")) {
+        const std::string &temp = args_helper.get_keyword_pair("--log-level");
+        if (temp.empty()) {
+            return false;
+        }
+        if (!Logger::parse_level(temp, args.log_level)) {
+            Logger::error() << "unknown log level '" << temp
+                            << "'. Please provide one of: debug, ok, info, warning, error.";
+            return false;
+        }
+    }
+    // "--verbose" is a shorthand for "--log-level debug"
     if (args_helper.check_if_exists("-v", "--verbose")) {
-        args.verbose = true;
+        args.log_level = Logger::level_t::debug;
+    }
+    args.verbose = (args.log_level == Logger::level_t::debug);
+    Logger::set_level(args.log_level);
+    return true;
+}
+
+bool parse_jobs_file(const std::string &filename, console_args_t &args)
+{
+    /*
+     * Read a jobs file, where every line is a single job written like commandline arguments, e.g.:
+     * --csv "data.csv" --column 1 --words "words.txt" --output "output.csv"
+     *
+     * Options that are missing from a line fall back to the defaults.
+     * Lines beginning with "#" and empty lines are ignored.
+     *
+     * Return True if everything worked as expected, False if failed.
+     */
+    std::vector<std::string> lines;
+    if (!DiskManager::load_lines_from_disk(filename, args.verbose, lines)) {
+        Logger::error() << "the jobs file is empty: '" << filename << "'.";
+        return false;
+    }
+    for (std::size_t i = 0; i != lines.size(); ++i) {
+        console_args_t job = args;
+        job.jobs.clear();
+        if (!parse_job_args(ArgsHelper(split_line(lines[i])), job)) {
+            Logger::error() << "invalid job on line '" << (i + 1) << "' of the jobs file: '"
+                            << filename << "'.";
+            return false;
+        }
+        args.jobs.push_back(job);
     }
     return true;
 }
+
+std::vector<std::string> split_line(const std::string &line)
+{
+    /*
+     * Split a line written like commandline arguments (e.g., a line of the jobs file) on whitespace,
+     * but keep double-quoted values (e.g., paths that contain spaces) together.
+     */
+    std::vector<std::string> tokens;
+    std::string token;
+    bool in_quotes = false;
+    bool has_token = false;
+    for (const char c : line) {
+        if (c == '"') {
+            in_quotes = !in_quotes;
+            has_token = true;
+        }
+        else if (!in_quotes && (c == ' ' || c == '\t' || c == '\r')) {
+            if (has_token) {
+                tokens.push_back(token);
+                token.clear();
+                has_token = false;
+            }
+        }
+        else {
+            token += c;
+            has_token = true;
+        }
+    }
+    if (has_token) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+bool parse_args(console_args_t &args)
+{
+    /*
+     * Read filenames from commandline arguments (or a jobs file), then check if they exist.
+     *
+     * Return True if everything worked as expected, False if failed.
+     */
+    const ArgsHelper args_helper(args.argc, args.argv);
+    if (args_helper.check_if_exists("-h", "--help")) {
+        print_help(args.argv[0], args);
+        return false;
+    }
+    if (!parse_run_args(args_helper, args)) {
+        return false;
+    }
+    if (args_helper.check_if_exists("--jobs")) {
+        const std::string &filename = args_helper.get_keyword_pair("--jobs");
+        if (filename.empty()) {
+            Logger::error() << "please provide a path to the jobs file "
+                               "(e.g., 'jobs.txt').";
+            return false;
+        }
+        if (!std::filesystem::exists(filename)) {
+            Logger::fatal() << "jobs file doesn't exist: '" << filename
+                            << "'. Please create a list of newline-separated jobs.";
+            exit(EXIT_FAILURE);
+        }
+        return parse_jobs_file(filename, args);
+    }
+    return parse_job_args(args_helper, args);
+}
 }  // namespace ConsoleInput
@@ -1,7 +1,11 @@
 #pragma once
 
 // libraries
+#include "Logger.hpp"
+#include "Normalizer.hpp"
+#include "OutputWriter.hpp"
 #include <string>
+#include <vector>
 
 // custom namespace
 namespace ConsoleInput {
@@ -13,11 +17,31 @@ struct console_args_t {
     std::string filename_words;
     std::string filename_csv;
     std::string filename_output;
+    std::string filename_rejects;  // empty if invalid rows are only counted and skipped
+    OutputWriter::format_t output_format;  // how matching rows are written to "filename_output"
     std::size_t word_column_idx;
-    bool verbose;
+    std::string where;  // empty if rows aren't filtered
+    std::string schema;  // empty if column types are only inferred from the first rows
+    Normalizer::options_t normalize;  // how keys and target words are normalized before comparing them
+    std::size_t max_distance;  // 0 if keys must match target words exactly (after normalization)
+    bool all_matches;  // save every matching row instead of the first one of each target word
+    bool incremental;  // only process rows appended since the last run, and append their matches to the output
+    std::string aggregate;  // empty if rows are saved instead of totals per target word
+    std::size_t threads;
+    bool read_ahead;  // read uncompressed CSV files with several reads in flight instead of mapping them
+    bool verbose;  // same as "log_level == debug"
+    Logger::level_t log_level;
+    bool build_index;
+    bool build_cache;
+    bool serve;  // answer queries against resident corpora instead of running the jobs once
+    std::string filename_socket;  // empty if "--serve" reads queries from stdin
+    bool stats;
+    std::string filename_stats;  // empty if stats shouldn't be saved as JSON
+    std::vector<console_args_t> jobs;  // filled from "--jobs", each job is a copy of these args with its own files
 };
 
 // prototypes
+std::vector<std::string> split_line(const std::string &line);
 bool parse_args(console_args_t &args);
 
 }  // namespace ConsoleInput
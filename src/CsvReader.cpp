@@ -0,0 +1,346 @@
+#include "CsvReader.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <array>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace CsvReader {
+
+MappedFile::MappedFile(const std::string &filename)
+/*
+ * Class constructor.
+ *
+ * Map the entire file into memory (read-only), so rows can be handed out as views
+ * without copying them out of the page cache first.
+ *
+ * NOTE: errors are logged, not fatal (this runs inside the library), so check "is_open()" before using the data.
+ */
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        Logger::error() << "could not open '" << filename
+                        << "' when mapping CSV into memory, "
+                           "possibly due to missing permissions to the filesystem.";
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        Logger::error() << "could not get the size of '" << filename << "'.";
+        return;
+    }
+    this->length = static_cast<std::size_t>(st.st_size);
+    // mapping an empty file fails, so leave it as an empty view
+    if (this->length != 0) {
+        this->address = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (this->address == MAP_FAILED) {
+            close(fd);
+            this->address = nullptr;
+            this->length = 0;
+            Logger::error() << "could not map '" << filename << "' into memory.";
+            return;
+        }
+        // the file is read front to back, so let the kernel read ahead aggressively
+        madvise(this->address, this->length, MADV_SEQUENTIAL);
+    }
+    // mapping stays valid after closing the file descriptor
+    close(fd);
+    this->opened = true;
+}
+
+MappedFile::~MappedFile()
+/*
+ * Class destructor.
+ */
+{
+    if (this->address != nullptr) {
+        munmap(this->address, this->length);
+    }
+}
+
+bool MappedFile::is_open() const
+/*
+ * Return True if the file was mapped (an empty file counts), False if opening or mapping it failed.
+ */
+{
+    return this->opened;
+}
+
+std::string_view MappedFile::data() const
+{
+    return std::string_view(static_cast<const char *>(this->address), this->length);
+}
+
+Reader::Reader(const std::string_view data, const std::size_t start)
+/*
+ * Class constructor.
+ *
+ * "start" must be the beginning of a row (or of the data).
+ */
+    : data(data), scanner(data, start), pos(start)
+{
+}
+
+std::size_t Reader::offset() const
+/*
+ * Return the offset of the first byte that was not consumed yet.
+ */
+{
+    return this->pos;
+}
+
+field_t Reader::make_field(const std::string_view raw)
+/*
+ * Strip surrounding quotes from a raw field and remember whether it contains escaped quotes.
+ * Anything between the closing quote and the delimiter is ignored.
+ */
+{
+    if (raw.empty() || raw.front() != '"') {
+        return field_t{raw, false};
+    }
+    // the closing quote is the first one that isn't followed by another quote, any quote after it is ignored too
+    bool escaped = false;
+    std::size_t quote = raw.find('"', 1);
+    while (quote != std::string_view::npos && quote + 1 < raw.size() && raw[quote + 1] == '"') {
+        escaped = true;
+        quote = raw.find('"', quote + 2);
+    }
+    const std::string_view inner = (quote == std::string_view::npos) ? raw.substr(1) : raw.substr(1, quote - 1);
+    return field_t{inner, escaped};
+}
+
+bool Reader::next_row(row_t &row)
+/*
+ * Split the next row into fields.
+ * Fields may be quoted ("a, b"), and quotes inside quoted fields are escaped by doubling them ("say ""hi""").
+ * Both "\n" and "\r\n" line endings are accepted; empty lines are skipped.
+ *
+ * Field boundaries come from the structural scanner, so bytes between delimiters are never looked at one by one.
+ *
+ * Return True if a row was read, False if the end of the input was reached.
+ */
+{
+    const char *const begin = this->data.data();
+    const std::size_t size = this->data.size();
+    std::size_t separator;
+    // skip empty lines
+    while (true) {
+        if (this->pos >= size) {
+            return false;
+        }
+        separator = this->scanner.next();
+        const bool is_empty_line = separator < size && begin[separator] == '\n' &&
+                                   (separator == this->pos || (separator == this->pos + 1 && begin[this->pos] == '\r'));
+        if (!is_empty_line) {
+            break;
+        }
+        this->pos = separator + 1;
+    }
+    row.fields.clear();
+    const std::size_t row_start = this->pos;
+    std::size_t field_start = this->pos;
+    while (true) {
+        const bool is_row_end = separator >= size || begin[separator] == '\n';
+        std::size_t field_end = separator;
+        if (is_row_end && field_end > field_start && begin[field_end - 1] == '\r') {
+            --field_end;
+        }
+        row.fields.push_back(make_field(std::string_view(begin + field_start, field_end - field_start)));
+        if (is_row_end) {
+            row.bytes = std::string_view(begin + row_start, field_end - row_start);
+            this->pos = (separator >= size) ? size : separator + 1;
+            row.line = std::string_view(begin + row_start, this->pos - row_start);
+            return true;
+        }
+        // delimiter, continue with the next field
+        field_start = separator + 1;
+        separator = this->scanner.next();
+    }
+}
+
+std::string_view field_value(const field_t &field, std::string &buffer)
+/*
+ * Return the value of a field with doubled quotes collapsed.
+ * Only escaped fields are copied (into "buffer"), all other fields are returned as-is.
+ */
+{
+    if (!field.escaped) {
+        return field.view;
+    }
+    buffer.clear();
+    for (std::size_t i = 0; i < field.view.size(); ++i) {
+        buffer += field.view[i];
+        if (field.view[i] == '"' && i + 1 < field.view.size() && field.view[i + 1] == '"') {
+            ++i;
+        }
+    }
+    return buffer;
+}
+
+std::string field_to_string(const field_t &field)
+/*
+ * Copy the value of a field into a new string.
+ */
+{
+    std::string buffer;
+    const std::string_view value = field_value(field, buffer);
+    return field.escaped ? buffer : std::string(value);
+}
+
+RowStore::RowStore(const bool keep_raw)
+/*
+ * Class constructor.
+ *
+ * With "keep_raw", every row is also copied as it appears in the input (see "raw()"), e.g., for compressed input,
+ * whose rows are gone once the next block is decompressed. Without it, only the size of every row is kept,
+ * and mapped input is read again at "offset()".
+ */
+    : keep_raw(keep_raw)
+{
+}
+
+std::size_t RowStore::add(const row_t &row, const std::size_t offset)
+/*
+ * Copy the values of all fields of "row" (with doubled quotes collapsed) to the end of the store.
+ * The buffers only grow, so once they are large enough, adding a row doesn't allocate at all.
+ *
+ * Return the index of the new row.
+ */
+{
+    this->entries.push_back(entry_t{offset, row.line.size(), this->raw_bytes.size(), this->field_ends.size(), row.fields.size()});
+    if (this->keep_raw) {
+        this->raw_bytes.insert(this->raw_bytes.end(), row.line.begin(), row.line.end());
+    }
+    for (const field_t &field : row.fields) {
+        if (!field.escaped) {
+            this->bytes.insert(this->bytes.end(), field.view.begin(), field.view.end());
+        }
+        else {
+            for (std::size_t i = 0; i < field.view.size(); ++i) {
+                this->bytes.push_back(field.view[i]);
+                if (field.view[i] == '"' && i + 1 < field.view.size() && field.view[i + 1] == '"') {
+                    ++i;
+                }
+            }
+        }
+        this->field_ends.push_back(this->bytes.size());
+    }
+    return this->entries.size() - 1;
+}
+
+std::size_t RowStore::size() const
+{
+    return this->entries.size();
+}
+
+std::size_t RowStore::offset(const std::size_t row) const
+{
+    return this->entries[row].offset;
+}
+
+std::size_t RowStore::raw_size(const std::size_t row) const
+{
+    return this->entries[row].raw_size;
+}
+
+std::string_view RowStore::raw(const std::size_t row) const
+/*
+ * Return the entire row as it appeared in the input, including its line terminator,
+ * or an empty view if rows aren't kept (see the constructor).
+ * The view is invalidated by the next "add()".
+ */
+{
+    if (!this->keep_raw) {
+        return std::string_view();
+    }
+    const entry_t &entry = this->entries[row];
+    return std::string_view(this->raw_bytes.data() + entry.raw_begin, entry.raw_size);
+}
+
+std::size_t RowStore::field_count(const std::size_t row) const
+{
+    return this->entries[row].field_count;
+}
+
+std::string_view RowStore::field(const std::size_t row, const std::size_t field) const
+/*
+ * Return the value of a field. The view is invalidated by the next "add()".
+ */
+{
+    const std::size_t idx = this->entries[row].first_field + field;
+    const std::size_t begin = (idx == 0) ? 0 : this->field_ends[idx - 1];
+    return std::string_view(this->bytes.data() + begin, this->field_ends[idx] - begin);
+}
+
+void RowStore::clear()
+/*
+ * Forget all rows at once; the memory is kept, so the store can be refilled without allocating.
+ */
+{
+    this->bytes.clear();
+    this->field_ends.clear();
+    this->entries.clear();
+    this->raw_bytes.clear();
+}
+
+std::vector<std::size_t> split_rows(const std::string_view data, const std::size_t start, const std::size_t chunks)
+/*
+ * Split "data" (from "start" onwards, which must be a row start) into up to "chunks" ranges of roughly equal size.
+ * Return "chunks + 1" offsets, where range "k" holds all rows that begin in [offsets[k], offsets[k + 1]).
+ *
+ * A byte boundary can land inside a quoted field, so every range is first scanned (in parallel) for the state it ends in,
+ * once for each state it may begin in (see "StructuralScanner::state_t"). Chaining these from the start gives the exact
+ * state at every boundary, which is then moved forward to the byte after the next unquoted newline.
+ */
+{
+    const std::size_t size = data.size();
+    if (chunks <= 1 || size - start < chunks * 64) {
+        return {start, size};
+    }
+    // scanning for a boundary starts one byte early, so a row that begins exactly on the boundary is kept
+    const std::size_t step = (size - start) / chunks;
+    std::vector<std::size_t> scan_starts(chunks + 1);
+    for (std::size_t k = 0; k != chunks; ++k) {
+        scan_starts[k] = (k == 0) ? start : start + k * step - 1;
+    }
+    scan_starts[chunks] = size;
+    using StructuralScanner::state_t;
+    // end state of every range, indexed by the state it begins in
+    std::vector<std::array<state_t, 3>> end_states(chunks);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks);
+    for (std::size_t k = 0; k != chunks; ++k) {
+        workers.emplace_back([&, k]() {
+            const std::string_view range = data.substr(scan_starts[k], scan_starts[k + 1] - scan_starts[k]);
+            std::array<state_t, 3> &ends = end_states[k];
+            ends[static_cast<std::size_t>(state_t::field_start)] = StructuralScanner::scan_state(range, state_t::field_start);
+            ends[static_cast<std::size_t>(state_t::quoted)] = StructuralScanner::scan_state(range, state_t::quoted);
+            // both states only differ if the range begins with a quote
+            ends[static_cast<std::size_t>(state_t::unquoted)] = (range.front() == '"')
+                                                                    ? StructuralScanner::scan_state(range, state_t::unquoted)
+                                                                    : ends[static_cast<std::size_t>(state_t::field_start)];
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    std::vector<std::size_t> offsets{start};
+    state_t state = state_t::field_start;
+    for (std::size_t k = 1; k != chunks; ++k) {
+        state = end_states[k - 1][static_cast<std::size_t>(state)];
+        StructuralScanner::Scanner scanner(data, scan_starts[k], state);
+        std::size_t separator = scanner.next();
+        while (separator < size && data[separator] != '\n') {
+            separator = scanner.next();
+        }
+        offsets.push_back(std::max(offsets.back(), std::min(separator + 1, size)));
+    }
+    offsets.push_back(size);
+    return offsets;
+}
+
+}  // namespace CsvReader
@@ -0,0 +1,90 @@
+#pragma once
+
+// libraries
+#include "StructuralScanner.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace CsvReader {
+
+// types
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool is_open() const;
+    std::string_view data() const;
+
+  private:
+    void *address = nullptr;
+    std::size_t length = 0;
+    bool opened = false;
+};
+
+struct field_t {
+    std::string_view view;  // points into the input, surrounding quotes are stripped
+    bool escaped;           // quoted field that still contains doubled quotes ("")
+};
+
+struct row_t {
+    std::string_view bytes;      // entire row as it appears in the input, without the line terminator
+    std::string_view line;       // same, but followed by its line terminator ("\n" or "\r\n"), if it has one
+    std::vector<field_t> fields;  // reused between rows, so it stops allocating after the first few rows
+};
+
+class Reader {
+  public:
+    explicit Reader(const std::string_view data, const std::size_t start = 0);
+
+    bool next_row(row_t &row);
+    std::size_t offset() const;
+
+  private:
+    std::string_view data;
+    StructuralScanner::Scanner scanner;
+    std::size_t pos = 0;
+
+    static field_t make_field(const std::string_view raw);
+};
+
+class RowStore {
+  public:
+    explicit RowStore(const bool keep_raw = false);
+
+    std::size_t add(const row_t &row, const std::size_t offset);
+    std::size_t size() const;
+    std::size_t offset(const std::size_t row) const;
+    std::size_t raw_size(const std::size_t row) const;
+    std::string_view raw(const std::size_t row) const;
+    std::size_t field_count(const std::size_t row) const;
+    std::string_view field(const std::size_t row, const std::size_t field) const;
+    void clear();
+
+  private:
+    struct entry_t {
+        std::size_t offset;       // byte offset of the row in the input
+        std::size_t raw_size;     // size of the row in the input, including its line terminator
+        std::size_t raw_begin;    // start of the row in "raw_bytes", only if "keep_raw" is set
+        std::size_t first_field;  // index of the row's first field in "field_ends"
+        std::size_t field_count;
+    };
+
+    std::vector<char> bytes;              // values of all fields of all rows, back to back
+    std::vector<std::size_t> field_ends;  // end of each field in "bytes", its start is the end of the previous one
+    std::vector<entry_t> entries;
+    std::vector<char> raw_bytes;          // entire rows as they appear in the input, only if "keep_raw" is set
+    bool keep_raw = false;                // for input that isn't mapped, where rows can't be read again at their offset
+};
+
+// prototypes
+std::string_view field_value(const field_t &field, std::string &buffer);
+std::string field_to_string(const field_t &field);
+std::vector<std::size_t> split_rows(const std::string_view data, const std::size_t start, const std::size_t chunks);
+
+}  // namespace CsvReader
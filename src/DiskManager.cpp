@@ -1,85 +1,317 @@
 #include "DiskManager.hpp"
 #include "ConsoleInput.hpp"
+#include "Logger.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
 #include <fstream>
-#include <iostream>
+#include <unistd.h>
 #include <vector>
 
 namespace DiskManager {
-void create_empty_file(const std::string &filename)
+bool create_empty_file(const std::string &filename)
 {
     /*
      * Create empty file.
      *
      * NOTE: it will overwrite if already exists, make sure to check for that beforehand.
+     *
+     * Return True if succeeded, False if failed.
      */
     std::ofstream file_str(filename);
     if (!file_str) {
-        std::cerr << "FATAL ERROR: could not open ofstream for '" << filename
-                  << "' when creating empty file, "
-                     "possibly due to missing permissions to the filesystem.\n";
-        exit(EXIT_FAILURE);
+        Logger::error() << "could not open ofstream for '" << filename
+                        << "' when creating empty file, "
+                           "possibly due to missing permissions to the filesystem.";
+        return false;
     }
     file_str << '\n';
+    return true;
 }
 
-bool load_words_from_disk(const ConsoleInput::console_args_t &args, std::vector<std::string> &vec)
+bool LineFile::load(const std::string &filename, const bool verbose)
 /*
- * Read txt file from disk and append it to the "vec" vector.
+ * Map txt file into memory and split it into lines, skipping comments and empty lines.
+ * Lines are views into the mapping, so even a list of millions of words is loaded without copying a single one;
+ * it stays mapped until this object is destroyed or loads another file.
+ *
+ * Return True if at least one line was read, False if the file contains nothing (or couldn't be opened, see "is_open()").
  */
 {
-    std::string line;
-    std::ifstream file_str(args.filename_words);  // filehandle is closed automatically
-    if (!file_str) {
-        std::cerr << "FATAL ERROR: could not open ifstream for '" << args.filename_words
-                  << "' when loading words from disk, "
-                     "possibly due to missing permissions to the filesystem.\n";
-        exit(EXIT_FAILURE);
+    this->lines.clear();
+    this->file.reset();
+    if (!this->file.emplace(filename).is_open()) {
+        return false;
     }
-    // while exists, append to string with newline
-    while (std::getline(file_str, line)) {
-        // ignore comments (lines beginning with "#")
-        if (line[0] == '#') {
-            if (args.verbose) {
-                std::cout << "DEBUG: skipping commented-out line: '" << line << "'\n";
+    const std::string_view data = this->file->data();
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        const void *newline = std::memchr(data.data() + pos, '\n', data.size() - pos);
+        const std::size_t end = (newline == nullptr) ? data.size()
+                                                     : static_cast<std::size_t>(static_cast<const char *>(newline) - data.data());
+        std::string_view line = data.substr(pos, end - pos);
+        pos = end + 1;
+        // files written on Windows end their lines with "\r\n"
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            if (verbose) {
+                Logger::debug() << "skipping empty line: '" << line << "'";
             }
             continue;
         }
-        if (line.empty()) {
-            if (args.verbose) {
-                std::cout << "DEBUG: skipping empty line: '" << line << "'\n";
+        // ignore comments (lines beginning with "#")
+        if (line[0] == '#') {
+            if (verbose) {
+                Logger::debug() << "skipping commented-out line: '" << line << "'";
             }
             continue;
         }
-        vec.push_back(line);
+        this->lines.push_back(line);
     }
     // file exists, but contains nothing
-    if (vec.empty()) {  // filename, text to modify
-        std::cerr << "ERROR: the words file is empty: '" << args.filename_words
-                  << "'.\n";
+    return !this->lines.empty();
+}
+
+bool LineFile::is_open() const
+/*
+ * Return True if the last "load()" mapped its file, False if opening it failed.
+ */
+{
+    return this->file.has_value() && this->file->is_open();
+}
+
+const std::vector<std::string_view> &LineFile::get_lines() const
+{
+    return this->lines;
+}
+
+bool load_lines_from_disk(const std::string &filename, const bool verbose, std::vector<std::string> &vec)
+/*
+ * Read txt file from disk and append copies of its lines to the "vec" vector, skipping comments and empty lines.
+ *
+ * Return True if at least one line was read, False if the file contains nothing.
+ */
+{
+    LineFile file;
+    if (!file.load(filename, verbose)) {
         return false;
     }
-    vec.shrink_to_fit();
+    vec.insert(vec.end(), file.get_lines().begin(), file.get_lines().end());
     return true;
 }
 
-bool save_csv_to_disk(const ConsoleInput::console_args_t &args, const std::string &s)
+bool load_words_from_disk(const ConsoleInput::console_args_t &args, LineFile &words)
 /*
- * Save "s" string to disk as a txt file.
+ * Map the words file into memory and split it into target words, see "LineFile::load()".
  */
 {
-    if (s.empty()) {  // filename, text to modify
-        std::cerr << "ERROR: the string to be saved is empty: '" << s
-                  << "'.\n";
+    if (!words.load(args.filename_words, args.verbose)) {
+        // failing to open the file was already reported
+        if (!words.is_open()) {
+            return false;
+        }
+        Logger::error() << "the words file is empty: '" << args.filename_words
+                        << "'.";
         return false;
     }
-    std::ofstream file_str(args.filename_output);
-    if (!file_str) {
-        std::cerr << "FATAL ERROR: could not open ofstream for '" << args.filename_output
-                  << "' when saving CSV to disk, "
-                     "possibly due to missing permissions to the filesystem.\n";
-        exit(EXIT_FAILURE);
+    return true;
+}
+
+BufferedWriter::BufferedWriter(const std::string &filename, const bool append, const std::size_t buffer_size)
+/*
+ * Class constructor.
+ *
+ * Open (and truncate, unless "append" is set) "filename" for writing. Everything passed to "write()" goes through a fixed-size buffer,
+ * so memory use stays the same no matter how much is written.
+ *
+ * NOTE: failing to open is logged, not fatal; everything written afterwards is dropped and "flush()" returns False.
+ */
+    : filename(filename), buffer(buffer_size)
+{
+    this->fd = open(filename.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+    if (this->fd == -1) {
+        Logger::error() << "could not open '" << filename
+                        << "' when saving CSV to disk, "
+                           "possibly due to missing permissions to the filesystem.";
+        this->failed = true;
+    }
+}
+
+BufferedWriter::~BufferedWriter()
+/*
+ * Class destructor.
+ */
+{
+    this->flush();
+    if (this->fd != -1) {
+        close(this->fd);
+    }
+}
+
+void BufferedWriter::write(const std::string_view s)
+/*
+ * Append "s" to the buffer, flushing it to disk whenever it fills up.
+ */
+{
+    if (this->failed) {
+        return;
+    }
+    // keep the order of the bytes passed to "write_view()" before
+    if (!this->views.empty() && !this->flush_views()) {
+        return;
+    }
+    std::size_t pos = 0;
+    while (pos < s.size()) {
+        if (this->used == this->buffer.size() && !this->flush()) {
+            return;
+        }
+        const std::size_t amount = std::min(s.size() - pos, this->buffer.size() - this->used);
+        std::memcpy(this->buffer.data() + this->used, s.data() + pos, amount);
+        this->used += amount;
+        pos += amount;
+    }
+}
+
+void BufferedWriter::write_view(const std::string_view s)
+/*
+ * Write "s" without copying it into the buffer; it must stay valid until the next "flush()" (or "write()").
+ * Views are collected and written with a single "writev()" per "IOV_MAX" of them, and a view that continues
+ * right where the last one ended (e.g., adjacent rows of a mapped file) is merged into it.
+ */
+{
+    if (s.empty() || this->failed) {
+        return;
+    }
+    if (this->used != 0 && !this->flush()) {
+        return;
+    }
+    if (!this->views.empty()) {
+        iovec &last = this->views.back();
+        if (static_cast<const char *>(last.iov_base) + last.iov_len == s.data()) {
+            last.iov_len += s.size();
+            this->view_bytes += s.size();
+            return;
+        }
+    }
+    if (this->views.size() == IOV_MAX && !this->flush_views()) {
+        return;
+    }
+    // "writev()" never writes through "iov_base", it's only non-const because "readv()" shares the struct
+    this->views.push_back(iovec{const_cast<char *>(s.data()), s.size()});
+    this->view_bytes += s.size();
+}
+
+void BufferedWriter::put(const char c)
+{
+    if (this->failed) {
+        return;
+    }
+    if (!this->views.empty() && !this->flush_views()) {
+        return;
+    }
+    if (this->used == this->buffer.size() && !this->flush()) {
+        return;
+    }
+    this->buffer[this->used++] = c;
+}
+
+bool BufferedWriter::flush_views()
+/*
+ * Write the views collected by "write_view()" to disk, resuming after partial writes.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    if (this->failed) {
+        this->views.clear();
+        this->view_bytes = 0;
+        return false;
+    }
+    std::size_t first = 0;
+    while (first != this->views.size()) {
+        const int amount_views = static_cast<int>(std::min<std::size_t>(this->views.size() - first, IOV_MAX));
+        const ssize_t amount = ::writev(this->fd, this->views.data() + first, amount_views);
+        if (amount == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::error() << "failed to write to '" << this->filename << "'.";
+            this->failed = true;
+            this->views.clear();
+            this->view_bytes = 0;
+            return false;
+        }
+        // skip the views that were written entirely, and the written part of the next one
+        auto left = static_cast<std::size_t>(amount);
+        while (first != this->views.size() && left >= this->views[first].iov_len) {
+            left -= this->views[first].iov_len;
+            ++first;
+        }
+        if (left != 0) {
+            this->views[first].iov_base = static_cast<char *>(this->views[first].iov_base) + left;
+            this->views[first].iov_len -= left;
+        }
     }
-    file_str << s;
+    Stats::add(Stats::counter_t::bytes_written, this->view_bytes);
+    this->written += this->view_bytes;
+    this->views.clear();
+    this->view_bytes = 0;
     return true;
 }
+
+bool BufferedWriter::flush()
+/*
+ * Write the buffer (or the views passed to "write_view()") to disk.
+ *
+ * Return True if everything written so far reached the disk, False if any open or write failed (even an earlier one).
+ */
+{
+    if (!this->views.empty() && !this->flush_views()) {
+        return false;
+    }
+    if (this->failed) {
+        this->used = 0;
+        return false;
+    }
+    std::size_t pos = 0;
+    while (pos < this->used) {
+        const ssize_t amount = ::write(this->fd, this->buffer.data() + pos, this->used - pos);
+        if (amount == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::error() << "failed to write to '" << this->filename << "'.";
+            this->failed = true;
+            this->used = 0;
+            return false;
+        }
+        pos += static_cast<std::size_t>(amount);
+    }
+    Stats::add(Stats::counter_t::bytes_written, this->used);
+    this->written += this->used;
+    this->used = 0;
+    return true;
+}
+
+bool BufferedWriter::is_open() const
+/*
+ * Return True if the file was opened, False if opening it failed.
+ */
+{
+    return this->fd != -1;
+}
+
+std::size_t BufferedWriter::bytes_written() const
+/*
+ * Return the amount of bytes written so far, including those still in the buffer.
+ */
+{
+    return this->written + this->used + this->view_bytes;
+}
+
 }  // namespace DiskManager
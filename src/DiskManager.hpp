@@ -1,16 +1,64 @@
 #pragma once
 
 // libraries
-#include "ConsoleInput.hpp"
+#include "CsvReader.hpp"
+#include <cstddef>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <sys/uio.h>
 #include <vector>
 
+// declared, not included, because "ConsoleInput.hpp" includes "OutputWriter.hpp", which includes this header
+namespace ConsoleInput {
+struct console_args_t;
+}  // namespace ConsoleInput
+
 // custom namespace
 namespace DiskManager {
 
+// types
+class BufferedWriter {
+  public:
+    explicit BufferedWriter(const std::string &filename, const bool append = false, const std::size_t buffer_size = 1 << 16);
+    ~BufferedWriter();
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    void write(const std::string_view s);
+    void write_view(const std::string_view s);
+    void put(const char c);
+    bool flush();
+    bool is_open() const;
+    std::size_t bytes_written() const;
+
+  private:
+    std::string filename;
+    int fd = -1;
+    std::vector<char> buffer;  // fixed size, never grows
+    std::size_t used = 0;
+    std::size_t written = 0;
+    std::vector<iovec> views;  // bytes passed to "write_view()" that weren't written yet, at most "IOV_MAX"
+    std::size_t view_bytes = 0;
+    bool failed = false;  // sticky, set by the first failed open or write; everything written afterwards is dropped
+
+    bool flush_views();
+};
+
+class LineFile {
+  public:
+    bool load(const std::string &filename, const bool verbose);
+    bool is_open() const;
+    const std::vector<std::string_view> &get_lines() const;
+
+  private:
+    std::optional<CsvReader::MappedFile> file;
+    std::vector<std::string_view> lines;  // point into "file", without comments, empty lines and line terminators
+};
+
 // prototypes
-void create_empty_file(const std::string &filename);
-bool load_words_from_disk(const ConsoleInput::console_args_t &args, std::vector<std::string> &vec);
-bool save_csv_to_disk(const ConsoleInput::console_args_t &args, const std::string &s);
+bool create_empty_file(const std::string &filename);
+bool load_lines_from_disk(const std::string &filename, const bool verbose, std::vector<std::string> &vec);
+bool load_words_from_disk(const ConsoleInput::console_args_t &args, LineFile &words);
 
 }  // namespace DiskManager
@@ -0,0 +1,445 @@
+#include "InputStream.hpp"
+#include "Logger.hpp"
+#include "StructuralScanner.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef CSV_VALENCE_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CSV_VALENCE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t buffer_size = 1 << 20;  // 1 MiB of decompressed data per buffer, and the size of a block read ahead
+constexpr std::size_t buffer_amount = 4;      // buffers in flight between a reader and the parser
+constexpr std::size_t reader_amount = 4;      // readers of uncompressed input, which is the amount of reads in flight
+
+bool read_plain(const std::string &filename,
+                const int fd,
+                const std::size_t file_size,
+                const std::size_t first_block,
+                InputStream::BufferQueue &free,
+                InputStream::BufferQueue &filled)
+/*
+ * Read every "reader_amount"-th block of an uncompressed file, starting at "first_block", into buffers taken from "free",
+ * and push them to "filled". Blocks begin at multiples of "buffer_size", so every read is large and page-aligned.
+ *
+ * Return True if succeeded (or if the consumer stopped early), False if failed.
+ */
+{
+    std::vector<char> buffer;
+    for (std::size_t block = first_block; free.pop(buffer); block += reader_amount) {
+        const std::size_t offset = block * buffer_size;
+        if (offset >= file_size) {
+            break;
+        }
+        buffer.resize(std::min(buffer_size, file_size - offset));
+        // "pread()" may return fewer bytes than asked for, e.g., on network filesystems
+        std::size_t size = 0;
+        while (size != buffer.size()) {
+            const ssize_t amount = ::pread(fd, buffer.data() + size, buffer.size() - size, static_cast<off_t>(offset + size));
+            if (amount < 0 && errno == EINTR) {
+                continue;
+            }
+            if (amount < 0) {
+                Logger::error() << "failed to read '" << filename << "': " << std::strerror(errno) << ".";
+                return false;
+            }
+            if (amount == 0) {
+                Logger::error() << "'" << filename << "' was truncated while it was read.";
+                return false;
+            }
+            size += static_cast<std::size_t>(amount);
+        }
+        filled.push(std::move(buffer));
+    }
+    return true;
+}
+
+#ifdef CSV_VALENCE_HAS_ZLIB
+bool read_gzip(const std::string &filename, InputStream::BufferQueue &free, InputStream::BufferQueue &filled)
+/*
+ * Decompress a gzip file into buffers taken from "free" and push them to "filled".
+ * Files that consist of several concatenated gzip members are read as a whole.
+ *
+ * Return True if succeeded (or if the consumer stopped early), False if failed.
+ */
+{
+    gzFile file = gzopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        Logger::error() << "could not open '" << filename << "' for decompression.";
+        return false;
+    }
+    gzbuffer(file, 1 << 17);
+    bool success = true;
+    std::vector<char> buffer;
+    while (free.pop(buffer)) {
+        buffer.resize(buffer_size);
+        const int amount = gzread(file, buffer.data(), static_cast<unsigned>(buffer.size()));
+        int errnum = Z_OK;
+        const char *message = gzerror(file, &errnum);
+        if (amount < 0 || (errnum != Z_OK && errnum != Z_BUF_ERROR)) {
+            Logger::error() << "failed to decompress '" << filename << "': " << message << ".";
+            success = false;
+            break;
+        }
+        if (amount == 0) {
+            // zlib reports a file that ends in the middle of a member as a buffer error
+            if (errnum == Z_BUF_ERROR) {
+                Logger::error() << "'" << filename << "' is truncated.";
+                success = false;
+            }
+            break;
+        }
+        buffer.resize(static_cast<std::size_t>(amount));
+        filled.push(std::move(buffer));
+    }
+    gzclose(file);
+    return success;
+}
+#endif
+
+#ifdef CSV_VALENCE_HAS_ZSTD
+bool read_zstd(const std::string &filename, InputStream::BufferQueue &free, InputStream::BufferQueue &filled)
+/*
+ * Decompress a zstd file into buffers taken from "free" and push them to "filled".
+ *
+ * Return True if succeeded (or if the consumer stopped early), False if failed.
+ */
+{
+    std::FILE *file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        Logger::error() << "could not open '" << filename << "' for decompression.";
+        return false;
+    }
+    ZSTD_DCtx *context = ZSTD_createDCtx();
+    std::vector<char> input(ZSTD_DStreamInSize());
+    ZSTD_inBuffer in = {input.data(), 0, 0};
+    std::size_t frame_left = 0;  // non-zero while a frame is not fully decoded
+    bool eof = false;
+    bool success = true;
+    std::vector<char> buffer;
+    while (success && free.pop(buffer)) {
+        buffer.resize(buffer_size);
+        ZSTD_outBuffer out = {buffer.data(), buffer.size(), 0};
+        while (out.pos < out.size) {
+            if (in.pos == in.size && !eof) {
+                in.size = std::fread(input.data(), 1, input.size(), file);
+                in.pos = 0;
+                eof = (in.size == 0);
+            }
+            const std::size_t before = out.pos;
+            frame_left = ZSTD_decompressStream(context, &out, &in);
+            if (ZSTD_isError(frame_left)) {
+                Logger::error() << "failed to decompress '" << filename << "': " << ZSTD_getErrorName(frame_left) << ".";
+                success = false;
+                break;
+            }
+            // the decoder may still hold output after the input is exhausted, so stop only when it produces nothing
+            if (eof && out.pos == before) {
+                break;
+            }
+        }
+        if (!success || out.pos == 0) {
+            break;
+        }
+        buffer.resize(out.pos);
+        filled.push(std::move(buffer));
+    }
+    if (success && eof && frame_left != 0) {
+        Logger::error() << "'" << filename << "' is truncated.";
+        success = false;
+    }
+    ZSTD_freeDCtx(context);
+    std::fclose(file);
+    return success;
+}
+#endif
+
+std::size_t complete_end(const std::string_view window)
+/*
+ * Return the end of the last complete row in "window" (which begins with a row), or 0 if there is none.
+ *
+ * A row is complete if it's followed by a newline that is not inside a quoted field.
+ */
+{
+    const std::size_t newline = window.rfind('\n');
+    if (newline == std::string_view::npos) {
+        return 0;
+    }
+    // usually the last newline ends a row, which a single pass over the quotes before it confirms
+    using StructuralScanner::state_t;
+    if (StructuralScanner::scan_state(window.substr(0, newline), state_t::field_start) != state_t::quoted) {
+        return newline + 1;
+    }
+    // otherwise it's inside a quoted field, so the newlines before it are checked one by one
+    StructuralScanner::Scanner scanner(window, 0);
+    std::size_t end = 0;
+    for (std::size_t separator = scanner.next(); separator < newline; separator = scanner.next()) {
+        if (window[separator] == '\n') {
+            end = separator + 1;
+        }
+    }
+    return end;
+}
+
+}  // namespace
+
+namespace InputStream {
+
+BufferQueue::BufferQueue(const std::size_t capacity)
+/*
+ * Class constructor.
+ *
+ * "capacity" must fit every buffer that is ever pushed at once, because "push()" never waits.
+ */
+    : slots(capacity)
+{
+}
+
+void BufferQueue::push(std::vector<char> &&buffer)
+/*
+ * Add a buffer, only called by the producer.
+ */
+{
+    const std::size_t tail = this->tail.load(std::memory_order_relaxed);
+    this->slots[tail % this->slots.size()] = std::move(buffer);
+    this->tail.store(tail + 1, std::memory_order_release);
+    this->tail.notify_one();
+}
+
+bool BufferQueue::pop(std::vector<char> &buffer)
+/*
+ * Wait for the next buffer, only called by the consumer.
+ *
+ * Return True if a buffer was taken, False if the queue was closed.
+ */
+{
+    const std::size_t head = this->head.load(std::memory_order_relaxed);
+    std::size_t tail = this->tail.load(std::memory_order_acquire);
+    while (tail == head) {
+        this->tail.wait(tail, std::memory_order_acquire);
+        tail = this->tail.load(std::memory_order_acquire);
+    }
+    if (this->closed.load(std::memory_order_acquire)) {
+        return false;
+    }
+    buffer = std::move(this->slots[head % this->slots.size()]);
+    this->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void BufferQueue::close()
+/*
+ * Make "pop()" fail, only called by the producer, which must not push afterwards.
+ */
+{
+    this->closed.store(true, std::memory_order_release);
+    // a consumer that waits for the next buffer only wakes up once "tail" changes
+    this->tail.fetch_add(1, std::memory_order_release);
+    this->tail.notify_all();
+}
+
+reader_t::reader_t(const std::size_t buffers)
+/*
+ * Class constructor.
+ *
+ * Only "buffers" buffers are ever allocated, they are passed back and forth between the reader and the parser.
+ */
+    : filled(buffers + 1), free(buffers)
+{
+    for (std::size_t i = 0; i != buffers; ++i) {
+        std::vector<char> buffer;
+        buffer.reserve(buffer_size);
+        this->free.push(std::move(buffer));
+    }
+}
+
+RowStream::RowStream(const std::string &filename)
+/*
+ * Class constructor.
+ *
+ * Start reading "filename" on separate threads, so reading and parsing overlap. A compressed file is decompressed
+ * by a single reader, an uncompressed one is read by "reader_amount" readers that take turns, so slow storage
+ * (e.g., network filesystems or disks that aren't cached yet) always has several reads to work on.
+ */
+{
+    const format_t format = detect_format(filename);
+    std::size_t amount = 1;
+    if (format == format_t::plain) {
+        amount = reader_amount;
+        this->fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat file_stat;
+        if (this->fd >= 0 && ::fstat(this->fd, &file_stat) == 0) {
+            this->file_size = static_cast<std::size_t>(file_stat.st_size);
+            // the kernel may read even further ahead on its own
+            ::posix_fadvise(this->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+        else {
+            Logger::error() << "could not open '" << filename << "': " << std::strerror(errno) << ".";
+            this->error.store(true, std::memory_order_release);
+        }
+    }
+    for (std::size_t i = 0; i != amount; ++i) {
+        reader_t &reader = this->readers.emplace_back(buffer_amount);
+        reader.thread = std::thread(&RowStream::produce, this, filename, format, std::ref(reader), i);
+    }
+}
+
+RowStream::~RowStream()
+/*
+ * Class destructor.
+ *
+ * The parser may stop before the end (e.g., once all target words were found), so the readers are stopped first.
+ */
+{
+    for (reader_t &reader : this->readers) {
+        reader.free.close();
+    }
+    for (reader_t &reader : this->readers) {
+        reader.thread.join();
+    }
+    if (this->fd >= 0) {
+        ::close(this->fd);
+    }
+}
+
+void RowStream::produce(const std::string &filename, const format_t format, reader_t &reader, const std::size_t first_block)
+{
+    bool success = false;
+    switch (format) {
+    case format_t::gzip:
+#ifdef CSV_VALENCE_HAS_ZLIB
+        success = read_gzip(filename, reader.free, reader.filled);
+#endif
+        break;
+    case format_t::zstd:
+#ifdef CSV_VALENCE_HAS_ZSTD
+        success = read_zstd(filename, reader.free, reader.filled);
+#endif
+        break;
+    case format_t::plain:
+        success = this->fd >= 0 && read_plain(filename, this->fd, this->file_size, first_block, reader.free, reader.filled);
+        break;
+    }
+    if (!success) {
+        this->error.store(true, std::memory_order_release);
+    }
+    // an empty buffer marks the end
+    reader.filled.push(std::vector<char>());
+}
+
+bool RowStream::next(std::string_view &rows, std::size_t &offset)
+/*
+ * Return the next block of complete rows and its offset in the decompressed stream.
+ * The view stays valid until the next call. A row that continues in the next buffer is carried over,
+ * so a block never ends in the middle of a row.
+ *
+ * Return True if rows were returned, False if the end of the input was reached.
+ */
+{
+    // drop the rows returned last time, only the partial row (if any) is moved
+    this->window.erase(0, this->handed_out);
+    this->window_offset += this->handed_out;
+    this->handed_out = 0;
+    std::vector<char> buffer;
+    while (!this->finished) {
+        // blocks are taken from the readers in turn, which restores their order
+        reader_t &reader = this->readers[this->next_block % this->readers.size()];
+        reader.filled.pop(buffer);
+        if (buffer.empty()) {
+            this->finished = true;
+            break;
+        }
+        ++this->next_block;
+        this->window.append(buffer.data(), buffer.size());
+        reader.free.push(std::move(buffer));
+        this->handed_out = complete_end(this->window);
+        if (this->handed_out != 0) {
+            break;
+        }
+    }
+    // the last row doesn't need to end with a newline
+    if (this->finished) {
+        this->handed_out = this->window.size();
+    }
+    if (this->handed_out == 0) {
+        return false;
+    }
+    rows = std::string_view(this->window.data(), this->handed_out);
+    offset = this->window_offset;
+    return true;
+}
+
+bool RowStream::failed() const
+/*
+ * Return True if reading or decompression failed, which means that the rows returned so far are incomplete.
+ */
+{
+    return this->error.load(std::memory_order_acquire);
+}
+
+format_t detect_format(const std::string &filename)
+/*
+ * Detect compressed files by their magic bytes, so the file extension doesn't matter.
+ */
+{
+    unsigned char magic[4] = {0, 0, 0, 0};
+    std::ifstream file_str(filename, std::ios::binary);
+    file_str.read(reinterpret_cast<char *>(magic), sizeof(magic));
+    if (file_str.gcount() >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return format_t::gzip;
+    }
+    if (file_str.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return format_t::zstd;
+    }
+    return format_t::plain;
+}
+
+const char *format_name(const format_t format)
+{
+    switch (format) {
+    case format_t::gzip:
+        return "gzip";
+    case format_t::zstd:
+        return "zstd";
+    case format_t::plain:
+        break;
+    }
+    return "plain";
+}
+
+bool is_supported(const format_t format)
+/*
+ * Return True if this build can read "format", False if it was built without the library that decodes it.
+ */
+{
+    switch (format) {
+    case format_t::gzip:
+#ifdef CSV_VALENCE_HAS_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case format_t::zstd:
+#ifdef CSV_VALENCE_HAS_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    case format_t::plain:
+        break;
+    }
+    return true;
+}
+
+}  // namespace InputStream
@@ -0,0 +1,77 @@
+#pragma once
+
+// libraries
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// custom namespace
+namespace InputStream {
+
+// types
+enum class format_t {
+    plain,
+    gzip,  // ".csv.gz", needs zlib
+    zstd,  // ".csv.zst", needs libzstd
+};
+
+// lock-free ring of buffers between exactly one producer thread and one consumer thread
+class BufferQueue {
+  public:
+    explicit BufferQueue(const std::size_t capacity);
+
+    void push(std::vector<char> &&buffer);
+    bool pop(std::vector<char> &buffer);
+    void close();
+
+  private:
+    std::vector<std::vector<char>> slots;
+    alignas(64) std::atomic<std::size_t> head{0};  // buffers popped so far, only written by the consumer
+    alignas(64) std::atomic<std::size_t> tail{0};  // buffers pushed so far, only written by the producer
+    std::atomic<bool> closed{false};               // once set, "pop()" fails right away, even if buffers are left
+};
+
+// a thread that fills buffers with every n-th block of the input, so reads of several blocks are in flight at once
+struct reader_t {
+    BufferQueue filled;  // blocks in order, an empty buffer marks the end
+    BufferQueue free;    // buffers the reader may fill next, which bounds the memory in flight
+    std::thread thread;
+
+    explicit reader_t(const std::size_t buffers);
+};
+
+class RowStream {
+  public:
+    explicit RowStream(const std::string &filename);
+    ~RowStream();
+    RowStream(const RowStream &) = delete;
+    RowStream &operator=(const RowStream &) = delete;
+
+    bool next(std::string_view &rows, std::size_t &offset);
+    bool failed() const;
+
+  private:
+    // variables
+    std::deque<reader_t> readers;   // block i is read by reader "i % readers.size()"; deque, because readers must never move
+    std::size_t next_block = 0;     // block that "next()" takes next
+    int fd = -1;                    // uncompressed input, shared by all readers, -1 if compressed
+    std::size_t file_size = 0;      // size of the uncompressed input when it was opened, later appends aren't read
+    std::atomic<bool> error{false};
+    std::string window;             // rows returned by the last "next()", followed by a partial row
+    std::size_t handed_out = 0;     // bytes at the start of "window" that were returned by the last "next()"
+    std::size_t window_offset = 0;  // offset of "window" in the decompressed stream
+    bool finished = false;          // the end marker was received
+
+    void produce(const std::string &filename, const format_t format, reader_t &reader, const std::size_t first_block);
+};
+
+// prototypes
+format_t detect_format(const std::string &filename);
+const char *format_name(const format_t format);
+bool is_supported(const format_t format);
+
+}  // namespace InputStream
@@ -0,0 +1,339 @@
+#include "Logger.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+namespace {
+
+struct message_t {
+    Logger::level_t level;
+    std::string text;
+};
+
+class RingBuffer {
+  private:
+    // types
+    struct cell_t {
+        std::atomic<std::size_t> sequence;
+        message_t message;
+    };
+
+    // variables
+    std::unique_ptr<cell_t[]> cells;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> enqueue_pos{0};
+    alignas(64) std::atomic<std::size_t> dequeue_pos{0};
+
+  public:
+    explicit RingBuffer(const std::size_t capacity)
+    /*
+     * Class constructor.
+     *
+     * Bounded lock-free queue (Dmitry Vyukov's design): every cell has a sequence number that tells
+     * producers and the consumer whether it is free or filled, so neither side ever takes a lock.
+     * "capacity" must be a power of two.
+     */
+        : cells(new cell_t[capacity]), mask(capacity - 1)
+    {
+        for (std::size_t i = 0; i != capacity; ++i) {
+            this->cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_push(message_t &message)
+    {
+        /*
+         * Return True if "message" was moved into the queue, False if the queue is full.
+         */
+        std::size_t pos = this->enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell_t &cell = this->cells[pos & this->mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (this->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.message = std::move(message);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = this->enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(message_t &message)
+    {
+        /*
+         * Return True if a message was moved out of the queue, False if the queue is empty.
+         */
+        std::size_t pos = this->dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell_t &cell = this->cells[pos & this->mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (this->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    message = std::move(cell.message);
+                    cell.sequence.store(pos + this->mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = this->dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+RingBuffer queue(1 << 14);
+std::thread consumer;
+std::atomic<bool> running{false};
+std::atomic<int> current_level{static_cast<int>(Logger::level_t::ok)};
+std::atomic<std::uint32_t> wake_ups{0};      // bumped by producers, the consumer sleeps on it
+std::atomic<std::uint64_t> pushed{0};        // messages accepted by the queue
+std::atomic<std::uint64_t> written{0};       // messages written by the consumer
+std::atomic<std::uint64_t> dropped{0};       // debug messages dropped because the queue was full
+
+const char *prefix(const Logger::level_t level)
+{
+    switch (level) {
+    case Logger::level_t::debug:
+        return "DEBUG: ";
+    case Logger::level_t::ok:
+        return "OK: ";
+    case Logger::level_t::info:
+        return "INFO: ";
+    case Logger::level_t::warning:
+        return "WARNING: ";
+    case Logger::level_t::error:
+        return "ERROR: ";
+    case Logger::level_t::fatal:
+        return "FATAL ERROR: ";
+    }
+    return "";
+}
+
+void write_message(const message_t &message)
+/*
+ * Print a message, errors go to stderr and everything else to stdout.
+ */
+{
+    std::FILE *file = (message.level >= Logger::level_t::error) ? stderr : stdout;
+    std::fputs(prefix(message.level), file);
+    std::fwrite(message.text.data(), 1, message.text.size(), file);
+    std::fputc('\n', file);
+}
+
+void drain()
+/*
+ * Background thread: write messages until "stop()" is called and the queue is empty.
+ * Output is flushed only when the queue runs dry, so bursts of messages cost a single write.
+ */
+{
+    message_t message;
+    while (true) {
+        const std::uint32_t seen = wake_ups.load(std::memory_order_acquire);
+        bool any = false;
+        while (queue.try_pop(message)) {
+            write_message(message);
+            written.fetch_add(1, std::memory_order_release);
+            any = true;
+        }
+        if (any) {
+            std::fflush(stdout);
+            std::fflush(stderr);
+            written.notify_all();
+            continue;
+        }
+        if (!running.load(std::memory_order_acquire)) {
+            break;
+        }
+        wake_ups.wait(seen, std::memory_order_acquire);
+    }
+}
+
+}  // namespace
+
+namespace Logger {
+
+Line::Line(const level_t level)
+/*
+ * Class constructor.
+ */
+    : level(level)
+{
+    if (is_enabled(level)) {
+        this->stream.emplace();
+    }
+}
+
+Line::~Line()
+/*
+ * Class destructor.
+ *
+ * Hand the finished line over to the background thread (or print it directly if it is not running).
+ */
+{
+    if (!this->stream) {
+        return;
+    }
+    message_t message{this->level, this->stream->str()};
+    if (!running.load(std::memory_order_acquire)) {
+        write_message(message);
+        return;
+    }
+    while (!queue.try_push(message)) {
+        // debug output is the only thing that is allowed to get lost, everything else waits for space
+        if (message.level == level_t::debug) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+    pushed.fetch_add(1, std::memory_order_release);
+    wake_ups.fetch_add(1, std::memory_order_release);
+    wake_ups.notify_one();
+}
+
+RateLimiter::RateLimiter(const std::size_t limit)
+/*
+ * Class constructor.
+ *
+ * Allow the first "limit" messages of a single call site, and count the rest, so they can be summarized.
+ */
+    : limit(limit)
+{
+}
+
+bool RateLimiter::allow()
+{
+    return this->count.fetch_add(1, std::memory_order_relaxed) < this->limit;
+}
+
+std::size_t RateLimiter::suppressed() const
+{
+    const std::size_t total = this->count.load(std::memory_order_relaxed);
+    return (total > this->limit) ? total - this->limit : 0;
+}
+
+void start(const level_t level)
+/*
+ * Start the background thread that prints messages.
+ * It is stopped automatically at exit, so messages printed right before "exit()" are not lost.
+ */
+{
+    set_level(level);
+    if (running.exchange(true)) {
+        return;
+    }
+    consumer = std::thread(drain);
+    static const bool registered = (std::atexit(stop) == 0);
+    (void)registered;
+}
+
+void stop()
+/*
+ * Print all queued messages and stop the background thread.
+ */
+{
+    if (!running.exchange(false)) {
+        return;
+    }
+    wake_ups.fetch_add(1, std::memory_order_release);
+    wake_ups.notify_one();
+    consumer.join();
+    const std::uint64_t amount = dropped.exchange(0);
+    if (amount != 0) {
+        write_message(message_t{level_t::debug, "dropped '" + std::to_string(amount) +
+                                                    "' messages, because they were printed faster than the terminal could show them."});
+    }
+    std::fflush(stdout);
+}
+
+void flush()
+/*
+ * Wait until every message queued so far is printed.
+ */
+{
+    const std::uint64_t target = pushed.load(std::memory_order_acquire);
+    std::uint64_t current = written.load(std::memory_order_acquire);
+    while (running.load(std::memory_order_acquire) && current < target) {
+        written.wait(current, std::memory_order_acquire);
+        current = written.load(std::memory_order_acquire);
+    }
+}
+
+void set_level(const level_t level)
+{
+    current_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+bool is_enabled(const level_t level)
+{
+    return static_cast<int>(level) >= current_level.load(std::memory_order_relaxed);
+}
+
+bool parse_level(const std::string &name, level_t &level)
+/*
+ * Convert a level name (e.g., "warning") to a level.
+ *
+ * Return True if succeeded, False if the name is unknown.
+ */
+{
+    static const std::pair<const char *, level_t> names[] = {
+        {"debug", level_t::debug},
+        {"ok", level_t::ok},
+        {"info", level_t::info},
+        {"warning", level_t::warning},
+        {"error", level_t::error},
+    };
+    for (const auto &[candidate, candidate_level] : names) {
+        if (name == candidate) {
+            level = candidate_level;
+            return true;
+        }
+    }
+    return false;
+}
+
+Line debug()
+{
+    return Line(level_t::debug);
+}
+
+Line ok()
+{
+    return Line(level_t::ok);
+}
+
+Line info()
+{
+    return Line(level_t::info);
+}
+
+Line warning()
+{
+    return Line(level_t::warning);
+}
+
+Line error()
+{
+    return Line(level_t::error);
+}
+
+Line fatal()
+{
+    return Line(level_t::fatal);
+}
+
+}  // namespace Logger
@@ -0,0 +1,71 @@
+#pragma once
+
+// libraries
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <sstream>
+#include <string>
+
+// custom namespace
+namespace Logger {
+
+// types
+enum class level_t {
+    debug,    // "DEBUG:", only with "--verbose"
+    ok,       // "OK:", one per match
+    info,     // "INFO:"
+    warning,  // "WARNING:"
+    error,    // "ERROR:", printed to stderr
+    fatal,    // "FATAL ERROR:", printed to stderr
+};
+
+class Line {
+  public:
+    explicit Line(const level_t level);
+    ~Line();
+    Line(const Line &) = delete;
+    Line &operator=(const Line &) = delete;
+
+    template <typename T>
+    Line &operator<<(const T &value)
+    {
+        // messages below the current level are never formatted
+        if (this->stream) {
+            *this->stream << value;
+        }
+        return *this;
+    }
+
+  private:
+    level_t level;
+    std::optional<std::ostringstream> stream;
+};
+
+class RateLimiter {
+  public:
+    explicit RateLimiter(const std::size_t limit);
+
+    bool allow();
+    std::size_t suppressed() const;
+
+  private:
+    std::size_t limit;
+    std::atomic<std::size_t> count{0};
+};
+
+// prototypes
+void start(const level_t level);
+void stop();
+void flush();
+void set_level(const level_t level);
+bool is_enabled(const level_t level);
+bool parse_level(const std::string &name, level_t &level);
+Line debug();
+Line ok();
+Line info();
+Line warning();
+Line error();
+Line fatal();
+
+}  // namespace Logger
@@ -0,0 +1,537 @@
+#include "Normalizer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+
+namespace {
+
+struct decomposition_t {
+    char32_t code;
+    bool compatibility;  // only used for NFKC, e.g., "ﬁ" -> "fi"
+    const char *decomposed;
+};
+
+struct folding_t {
+    char32_t code;
+    const char *folded;
+};
+
+// Generated from the Unicode Character Database (version 14.0), for Latin, Greek, Cyrillic,
+// general punctuation, letterlike symbols, number forms and Latin ligatures.
+// Decompositions are complete (e.g., "ǖ" -> "u" + U+0308 + U+0304), and lowercase ASCII letters are not listed.
+// Foldings only list characters without a decomposition, because those are folded after decomposing.
+constexpr decomposition_t decompositions[] = {
+    {0x00A0, true, " "}, {0x00A8, true, " \314\210"}, {0x00AA, true, "a"}, {0x00AF, true, " \314\204"},
+    {0x00B2, true, "2"}, {0x00B3, true, "3"}, {0x00B4, true, " \314\201"}, {0x00B5, true, "\316\274"},
+    {0x00B8, true, " \314\247"}, {0x00B9, true, "1"}, {0x00BA, true, "o"}, {0x00BC, true, "1\342\201\2044"},
+    {0x00BD, true, "1\342\201\2042"}, {0x00BE, true, "3\342\201\2044"}, {0x00C0, false, "A\314\200"}, {0x00C1, false, "A\314\201"},
+    {0x00C2, false, "A\314\202"}, {0x00C3, false, "A\314\203"}, {0x00C4, false, "A\314\210"}, {0x00C5, false, "A\314\212"},
+    {0x00C7, false, "C\314\247"}, {0x00C8, false, "E\314\200"}, {0x00C9, false, "E\314\201"}, {0x00CA, false, "E\314\202"},
+    {0x00CB, false, "E\314\210"}, {0x00CC, false, "I\314\200"}, {0x00CD, false, "I\314\201"}, {0x00CE, false, "I\314\202"},
+    {0x00CF, false, "I\314\210"}, {0x00D1, false, "N\314\203"}, {0x00D2, false, "O\314\200"}, {0x00D3, false, "O\314\201"},
+    {0x00D4, false, "O\314\202"}, {0x00D5, false, "O\314\203"}, {0x00D6, false, "O\314\210"}, {0x00D9, false, "U\314\200"},
+    {0x00DA, false, "U\314\201"}, {0x00DB, false, "U\314\202"}, {0x00DC, false, "U\314\210"}, {0x00DD, false, "Y\314\201"},
+    {0x00E0, false, "a\314\200"}, {0x00E1, false, "a\314\201"}, {0x00E2, false, "a\314\202"}, {0x00E3, false, "a\314\203"},
+    {0x00E4, false, "a\314\210"}, {0x00E5, false, "a\314\212"}, {0x00E7, false, "c\314\247"}, {0x00E8, false, "e\314\200"},
+    {0x00E9, false, "e\314\201"}, {0x00EA, false, "e\314\202"}, {0x00EB, false, "e\314\210"}, {0x00EC, false, "i\314\200"},
+    {0x00ED, false, "i\314\201"}, {0x00EE, false, "i\314\202"}, {0x00EF, false, "i\314\210"}, {0x00F1, false, "n\314\203"},
+    {0x00F2, false, "o\314\200"}, {0x00F3, false, "o\314\201"}, {0x00F4, false, "o\314\202"}, {0x00F5, false, "o\314\203"},
+    {0x00F6, false, "o\314\210"}, {0x00F9, false, "u\314\200"}, {0x00FA, false, "u\314\201"}, {0x00FB, false, "u\314\202"},
+    {0x00FC, false, "u\314\210"}, {0x00FD, false, "y\314\201"}, {0x00FF, false, "y\314\210"}, {0x0100, false, "A\314\204"},
+    {0x0101, false, "a\314\204"}, {0x0102, false, "A\314\206"}, {0x0103, false, "a\314\206"}, {0x0104, false, "A\314\250"},
+    {0x0105, false, "a\314\250"}, {0x0106, false, "C\314\201"}, {0x0107, false, "c\314\201"}, {0x0108, false, "C\314\202"},
+    {0x0109, false, "c\314\202"}, {0x010A, false, "C\314\207"}, {0x010B, false, "c\314\207"}, {0x010C, false, "C\314\214"},
+    {0x010D, false, "c\314\214"}, {0x010E, false, "D\314\214"}, {0x010F, false, "d\314\214"}, {0x0112, false, "E\314\204"},
+    {0x0113, false, "e\314\204"}, {0x0114, false, "E\314\206"}, {0x0115, false, "e\314\206"}, {0x0116, false, "E\314\207"},
+    {0x0117, false, "e\314\207"}, {0x0118, false, "E\314\250"}, {0x0119, false, "e\314\250"}, {0x011A, false, "E\314\214"},
+    {0x011B, false, "e\314\214"}, {0x011C, false, "G\314\202"}, {0x011D, false, "g\314\202"}, {0x011E, false, "G\314\206"},
+    {0x011F, false, "g\314\206"}, {0x0120, false, "G\314\207"}, {0x0121, false, "g\314\207"}, {0x0122, false, "G\314\247"},
+    {0x0123, false, "g\314\247"}, {0x0124, false, "H\314\202"}, {0x0125, false, "h\314\202"}, {0x0128, false, "I\314\203"},
+    {0x0129, false, "i\314\203"}, {0x012A, false, "I\314\204"}, {0x012B, false, "i\314\204"}, {0x012C, false, "I\314\206"},
+    {0x012D, false, "i\314\206"}, {0x012E, false, "I\314\250"}, {0x012F, false, "i\314\250"}, {0x0130, false, "I\314\207"},
+    {0x0132, true, "IJ"}, {0x0133, true, "ij"}, {0x0134, false, "J\314\202"}, {0x0135, false, "j\314\202"},
+    {0x0136, false, "K\314\247"}, {0x0137, false, "k\314\247"}, {0x0139, false, "L\314\201"}, {0x013A, false, "l\314\201"},
+    {0x013B, false, "L\314\247"}, {0x013C, false, "l\314\247"}, {0x013D, false, "L\314\214"}, {0x013E, false, "l\314\214"},
+    {0x013F, true, "L\302\267"}, {0x0140, true, "l\302\267"}, {0x0143, false, "N\314\201"}, {0x0144, false, "n\314\201"},
+    {0x0145, false, "N\314\247"}, {0x0146, false, "n\314\247"}, {0x0147, false, "N\314\214"}, {0x0148, false, "n\314\214"},
+    {0x0149, true, "\312\274n"}, {0x014C, false, "O\314\204"}, {0x014D, false, "o\314\204"}, {0x014E, false, "O\314\206"},
+    {0x014F, false, "o\314\206"}, {0x0150, false, "O\314\213"}, {0x0151, false, "o\314\213"}, {0x0154, false, "R\314\201"},
+    {0x0155, false, "r\314\201"}, {0x0156, false, "R\314\247"}, {0x0157, false, "r\314\247"}, {0x0158, false, "R\314\214"},
+    {0x0159, false, "r\314\214"}, {0x015A, false, "S\314\201"}, {0x015B, false, "s\314\201"}, {0x015C, false, "S\314\202"},
+    {0x015D, false, "s\314\202"}, {0x015E, false, "S\314\247"}, {0x015F, false, "s\314\247"}, {0x0160, false, "S\314\214"},
+    {0x0161, false, "s\314\214"}, {0x0162, false, "T\314\247"}, {0x0163, false, "t\314\247"}, {0x0164, false, "T\314\214"},
+    {0x0165, false, "t\314\214"}, {0x0168, false, "U\314\203"}, {0x0169, false, "u\314\203"}, {0x016A, false, "U\314\204"},
+    {0x016B, false, "u\314\204"}, {0x016C, false, "U\314\206"}, {0x016D, false, "u\314\206"}, {0x016E, false, "U\314\212"},
+    {0x016F, false, "u\314\212"}, {0x0170, false, "U\314\213"}, {0x0171, false, "u\314\213"}, {0x0172, false, "U\314\250"},
+    {0x0173, false, "u\314\250"}, {0x0174, false, "W\314\202"}, {0x0175, false, "w\314\202"}, {0x0176, false, "Y\314\202"},
+    {0x0177, false, "y\314\202"}, {0x0178, false, "Y\314\210"}, {0x0179, false, "Z\314\201"}, {0x017A, false, "z\314\201"},
+    {0x017B, false, "Z\314\207"}, {0x017C, false, "z\314\207"}, {0x017D, false, "Z\314\214"}, {0x017E, false, "z\314\214"},
+    {0x017F, true, "s"}, {0x01A0, false, "O\314\233"}, {0x01A1, false, "o\314\233"}, {0x01AF, false, "U\314\233"},
+    {0x01B0, false, "u\314\233"}, {0x01C4, true, "DZ\314\214"}, {0x01C5, true, "Dz\314\214"}, {0x01C6, true, "dz\314\214"},
+    {0x01C7, true, "LJ"}, {0x01C8, true, "Lj"}, {0x01C9, true, "lj"}, {0x01CA, true, "NJ"},
+    {0x01CB, true, "Nj"}, {0x01CC, true, "nj"}, {0x01CD, false, "A\314\214"}, {0x01CE, false, "a\314\214"},
+    {0x01CF, false, "I\314\214"}, {0x01D0, false, "i\314\214"}, {0x01D1, false, "O\314\214"}, {0x01D2, false, "o\314\214"},
+    {0x01D3, false, "U\314\214"}, {0x01D4, false, "u\314\214"}, {0x01D5, false, "U\314\210\314\204"}, {0x01D6, false, "u\314\210\314\204"},
+    {0x01D7, false, "U\314\210\314\201"}, {0x01D8, false, "u\314\210\314\201"}, {0x01D9, false, "U\314\210\314\214"}, {0x01DA, false, "u\314\210\314\214"},
+    {0x01DB, false, "U\314\210\314\200"}, {0x01DC, false, "u\314\210\314\200"}, {0x01DE, false, "A\314\210\314\204"}, {0x01DF, false, "a\314\210\314\204"},
+    {0x01E0, false, "A\314\207\314\204"}, {0x01E1, false, "a\314\207\314\204"}, {0x01E2, false, "\303\206\314\204"}, {0x01E3, false, "\303\246\314\204"},
+    {0x01E6, false, "G\314\214"}, {0x01E7, false, "g\314\214"}, {0x01E8, false, "K\314\214"}, {0x01E9, false, "k\314\214"},
+    {0x01EA, false, "O\314\250"}, {0x01EB, false, "o\314\250"}, {0x01EC, false, "O\314\250\314\204"}, {0x01ED, false, "o\314\250\314\204"},
+    {0x01EE, false, "\306\267\314\214"}, {0x01EF, false, "\312\222\314\214"}, {0x01F0, false, "j\314\214"}, {0x01F1, true, "DZ"},
+    {0x01F2, true, "Dz"}, {0x01F3, true, "dz"}, {0x01F4, false, "G\314\201"}, {0x01F5, false, "g\314\201"},
+    {0x01F8, false, "N\314\200"}, {0x01F9, false, "n\314\200"}, {0x01FA, false, "A\314\212\314\201"}, {0x01FB, false, "a\314\212\314\201"},
+    {0x01FC, false, "\303\206\314\201"}, {0x01FD, false, "\303\246\314\201"}, {0x01FE, false, "\303\230\314\201"}, {0x01FF, false, "\303\270\314\201"},
+    {0x0200, false, "A\314\217"}, {0x0201, false, "a\314\217"}, {0x0202, false, "A\314\221"}, {0x0203, false, "a\314\221"},
+    {0x0204, false, "E\314\217"}, {0x0205, false, "e\314\217"}, {0x0206, false, "E\314\221"}, {0x0207, false, "e\314\221"},
+    {0x0208, false, "I\314\217"}, {0x0209, false, "i\314\217"}, {0x020A, false, "I\314\221"}, {0x020B, false, "i\314\221"},
+    {0x020C, false, "O\314\217"}, {0x020D, false, "o\314\217"}, {0x020E, false, "O\314\221"}, {0x020F, false, "o\314\221"},
+    {0x0210, false, "R\314\217"}, {0x0211, false, "r\314\217"}, {0x0212, false, "R\314\221"}, {0x0213, false, "r\314\221"},
+    {0x0214, false, "U\314\217"}, {0x0215, false, "u\314\217"}, {0x0216, false, "U\314\221"}, {0x0217, false, "u\314\221"},
+    {0x0218, false, "S\314\246"}, {0x0219, false, "s\314\246"}, {0x021A, false, "T\314\246"}, {0x021B, false, "t\314\246"},
+    {0x021E, false, "H\314\214"}, {0x021F, false, "h\314\214"}, {0x0226, false, "A\314\207"}, {0x0227, false, "a\314\207"},
+    {0x0228, false, "E\314\247"}, {0x0229, false, "e\314\247"}, {0x022A, false, "O\314\210\314\204"}, {0x022B, false, "o\314\210\314\204"},
+    {0x022C, false, "O\314\203\314\204"}, {0x022D, false, "o\314\203\314\204"}, {0x022E, false, "O\314\207"}, {0x022F, false, "o\314\207"},
+    {0x0230, false, "O\314\207\314\204"}, {0x0231, false, "o\314\207\314\204"}, {0x0232, false, "Y\314\204"}, {0x0233, false, "y\314\204"},
+    {0x0340, false, "\314\200"}, {0x0341, false, "\314\201"}, {0x0343, false, "\314\223"}, {0x0344, false, "\314\210\314\201"},
+    {0x0374, false, "\312\271"}, {0x037A, true, " \315\205"}, {0x037E, false, ";"}, {0x0384, true, " \314\201"},
+    {0x0385, false, "\302\250\314\201"}, {0x0386, false, "\316\221\314\201"}, {0x0387, false, "\302\267"}, {0x0388, false, "\316\225\314\201"},
+    {0x0389, false, "\316\227\314\201"}, {0x038A, false, "\316\231\314\201"}, {0x038C, false, "\316\237\314\201"}, {0x038E, false, "\316\245\314\201"},
+    {0x038F, false, "\316\251\314\201"}, {0x0390, false, "\316\271\314\210\314\201"}, {0x03AA, false, "\316\231\314\210"}, {0x03AB, false, "\316\245\314\210"},
+    {0x03AC, false, "\316\261\314\201"}, {0x03AD, false, "\316\265\314\201"}, {0x03AE, false, "\316\267\314\201"}, {0x03AF, false, "\316\271\314\201"},
+    {0x03B0, false, "\317\205\314\210\314\201"}, {0x03CA, false, "\316\271\314\210"}, {0x03CB, false, "\317\205\314\210"}, {0x03CC, false, "\316\277\314\201"},
+    {0x03CD, false, "\317\205\314\201"}, {0x03CE, false, "\317\211\314\201"}, {0x03D0, true, "\316\262"}, {0x03D1, true, "\316\270"},
+    {0x03D2, true, "\316\245"}, {0x03D3, false, "\317\222\314\201"}, {0x03D4, false, "\317\222\314\210"}, {0x03D5, true, "\317\206"},
+    {0x03D6, true, "\317\200"}, {0x03F0, true, "\316\272"}, {0x03F1, true, "\317\201"}, {0x03F2, true, "\317\202"},
+    {0x03F4, true, "\316\230"}, {0x03F5, true, "\316\265"}, {0x03F9, true, "\316\243"}, {0x0400, false, "\320\225\314\200"},
+    {0x0401, false, "\320\225\314\210"}, {0x0403, false, "\320\223\314\201"}, {0x0407, false, "\320\206\314\210"}, {0x040C, false, "\320\232\314\201"},
+    {0x040D, false, "\320\230\314\200"}, {0x040E, false, "\320\243\314\206"}, {0x0419, false, "\320\230\314\206"}, {0x0439, false, "\320\270\314\206"},
+    {0x0450, false, "\320\265\314\200"}, {0x0451, false, "\320\265\314\210"}, {0x0453, false, "\320\263\314\201"}, {0x0457, false, "\321\226\314\210"},
+    {0x045C, false, "\320\272\314\201"}, {0x045D, false, "\320\270\314\200"}, {0x045E, false, "\321\203\314\206"}, {0x0476, false, "\321\264\314\217"},
+    {0x0477, false, "\321\265\314\217"}, {0x04C1, false, "\320\226\314\206"}, {0x04C2, false, "\320\266\314\206"}, {0x04D0, false, "\320\220\314\206"},
+    {0x04D1, false, "\320\260\314\206"}, {0x04D2, false, "\320\220\314\210"}, {0x04D3, false, "\320\260\314\210"}, {0x04D6, false, "\320\225\314\206"},
+    {0x04D7, false, "\320\265\314\206"}, {0x04DA, false, "\323\230\314\210"}, {0x04DB, false, "\323\231\314\210"}, {0x04DC, false, "\320\226\314\210"},
+    {0x04DD, false, "\320\266\314\210"}, {0x04DE, false, "\320\227\314\210"}, {0x04DF, false, "\320\267\314\210"}, {0x04E2, false, "\320\230\314\204"},
+    {0x04E3, false, "\320\270\314\204"}, {0x04E4, false, "\320\230\314\210"}, {0x04E5, false, "\320\270\314\210"}, {0x04E6, false, "\320\236\314\210"},
+    {0x04E7, false, "\320\276\314\210"}, {0x04EA, false, "\323\250\314\210"}, {0x04EB, false, "\323\251\314\210"}, {0x04EC, false, "\320\255\314\210"},
+    {0x04ED, false, "\321\215\314\210"}, {0x04EE, false, "\320\243\314\204"}, {0x04EF, false, "\321\203\314\204"}, {0x04F0, false, "\320\243\314\210"},
+    {0x04F1, false, "\321\203\314\210"}, {0x04F2, false, "\320\243\314\213"}, {0x04F3, false, "\321\203\314\213"}, {0x04F4, false, "\320\247\314\210"},
+    {0x04F5, false, "\321\207\314\210"}, {0x04F8, false, "\320\253\314\210"}, {0x04F9, false, "\321\213\314\210"}, {0x1E00, false, "A\314\245"},
+    {0x1E01, false, "a\314\245"}, {0x1E02, false, "B\314\207"}, {0x1E03, false, "b\314\207"}, {0x1E04, false, "B\314\243"},
+    {0x1E05, false, "b\314\243"}, {0x1E06, false, "B\314\261"}, {0x1E07, false, "b\314\261"}, {0x1E08, false, "C\314\247\314\201"},
+    {0x1E09, false, "c\314\247\314\201"}, {0x1E0A, false, "D\314\207"}, {0x1E0B, false, "d\314\207"}, {0x1E0C, false, "D\314\243"},
+    {0x1E0D, false, "d\314\243"}, {0x1E0E, false, "D\314\261"}, {0x1E0F, false, "d\314\261"}, {0x1E10, false, "D\314\247"},
+    {0x1E11, false, "d\314\247"}, {0x1E12, false, "D\314\255"}, {0x1E13, false, "d\314\255"}, {0x1E14, false, "E\314\204\314\200"},
+    {0x1E15, false, "e\314\204\314\200"}, {0x1E16, false, "E\314\204\314\201"}, {0x1E17, false, "e\314\204\314\201"}, {0x1E18, false, "E\314\255"},
+    {0x1E19, false, "e\314\255"}, {0x1E1A, false, "E\314\260"}, {0x1E1B, false, "e\314\260"}, {0x1E1C, false, "E\314\247\314\206"},
+    {0x1E1D, false, "e\314\247\314\206"}, {0x1E1E, false, "F\314\207"}, {0x1E1F, false, "f\314\207"}, {0x1E20, false, "G\314\204"},
+    {0x1E21, false, "g\314\204"}, {0x1E22, false, "H\314\207"}, {0x1E23, false, "h\314\207"}, {0x1E24, false, "H\314\243"},
+    {0x1E25, false, "h\314\243"}, {0x1E26, false, "H\314\210"}, {0x1E27, false, "h\314\210"}, {0x1E28, false, "H\314\247"},
+    {0x1E29, false, "h\314\247"}, {0x1E2A, false, "H\314\256"}, {0x1E2B, false, "h\314\256"}, {0x1E2C, false, "I\314\260"},
+    {0x1E2D, false, "i\314\260"}, {0x1E2E, false, "I\314\210\314\201"}, {0x1E2F, false, "i\314\210\314\201"}, {0x1E30, false, "K\314\201"},
+    {0x1E31, false, "k\314\201"}, {0x1E32, false, "K\314\243"}, {0x1E33, false, "k\314\243"}, {0x1E34, false, "K\314\261"},
+    {0x1E35, false, "k\314\261"}, {0x1E36, false, "L\314\243"}, {0x1E37, false, "l\314\243"}, {0x1E38, false, "L\314\243\314\204"},
+    {0x1E39, false, "l\314\243\314\204"}, {0x1E3A, false, "L\314\261"}, {0x1E3B, false, "l\314\261"}, {0x1E3C, false, "L\314\255"},
+    {0x1E3D, false, "l\314\255"}, {0x1E3E, false, "M\314\201"}, {0x1E3F, false, "m\314\201"}, {0x1E40, false, "M\314\207"},
+    {0x1E41, false, "m\314\207"}, {0x1E42, false, "M\314\243"}, {0x1E43, false, "m\314\243"}, {0x1E44, false, "N\314\207"},
+    {0x1E45, false, "n\314\207"}, {0x1E46, false, "N\314\243"}, {0x1E47, false, "n\314\243"}, {0x1E48, false, "N\314\261"},
+    {0x1E49, false, "n\314\261"}, {0x1E4A, false, "N\314\255"}, {0x1E4B, false, "n\314\255"}, {0x1E4C, false, "O\314\203\314\201"},
+    {0x1E4D, false, "o\314\203\314\201"}, {0x1E4E, false, "O\314\203\314\210"}, {0x1E4F, false, "o\314\203\314\210"}, {0x1E50, false, "O\314\204\314\200"},
+    {0x1E51, false, "o\314\204\314\200"}, {0x1E52, false, "O\314\204\314\201"}, {0x1E53, false, "o\314\204\314\201"}, {0x1E54, false, "P\314\201"},
+    {0x1E55, false, "p\314\201"}, {0x1E56, false, "P\314\207"}, {0x1E57, false, "p\314\207"}, {0x1E58, false, "R\314\207"},
+    {0x1E59, false, "r\314\207"}, {0x1E5A, false, "R\314\243"}, {0x1E5B, false, "r\314\243"}, {0x1E5C, false, "R\314\243\314\204"},
+    {0x1E5D, false, "r\314\243\314\204"}, {0x1E5E, false, "R\314\261"}, {0x1E5F, false, "r\314\261"}, {0x1E60, false, "S\314\207"},
+    {0x1E61, false, "s\314\207"}, {0x1E62, false, "S\314\243"}, {0x1E63, false, "s\314\243"}, {0x1E64, false, "S\314\201\314\207"},
+    {0x1E65, false, "s\314\201\314\207"}, {0x1E66, false, "S\314\214\314\207"}, {0x1E67, false, "s\314\214\314\207"}, {0x1E68, false, "S\314\243\314\207"},
+    {0x1E69, false, "s\314\243\314\207"}, {0x1E6A, false, "T\314\207"}, {0x1E6B, false, "t\314\207"}, {0x1E6C, false, "T\314\243"},
+    {0x1E6D, false, "t\314\243"}, {0x1E6E, false, "T\314\261"}, {0x1E6F, false, "t\314\261"}, {0x1E70, false, "T\314\255"},
+    {0x1E71, false, "t\314\255"}, {0x1E72, false, "U\314\244"}, {0x1E73, false, "u\314\244"}, {0x1E74, false, "U\314\260"},
+    {0x1E75, false, "u\314\260"}, {0x1E76, false, "U\314\255"}, {0x1E77, false, "u\314\255"}, {0x1E78, false, "U\314\203\314\201"},
+    {0x1E79, false, "u\314\203\314\201"}, {0x1E7A, false, "U\314\204\314\210"}, {0x1E7B, false, "u\314\204\314\210"}, {0x1E7C, false, "V\314\203"},
+    {0x1E7D, false, "v\314\203"}, {0x1E7E, false, "V\314\243"}, {0x1E7F, false, "v\314\243"}, {0x1E80, false, "W\314\200"},
+    {0x1E81, false, "w\314\200"}, {0x1E82, false, "W\314\201"}, {0x1E83, false, "w\314\201"}, {0x1E84, false, "W\314\210"},
+    {0x1E85, false, "w\314\210"}, {0x1E86, false, "W\314\207"}, {0x1E87, false, "w\314\207"}, {0x1E88, false, "W\314\243"},
+    {0x1E89, false, "w\314\243"}, {0x1E8A, false, "X\314\207"}, {0x1E8B, false, "x\314\207"}, {0x1E8C, false, "X\314\210"},
+    {0x1E8D, false, "x\314\210"}, {0x1E8E, false, "Y\314\207"}, {0x1E8F, false, "y\314\207"}, {0x1E90, false, "Z\314\202"},
+    {0x1E91, false, "z\314\202"}, {0x1E92, false, "Z\314\243"}, {0x1E93, false, "z\314\243"}, {0x1E94, false, "Z\314\261"},
+    {0x1E95, false, "z\314\261"}, {0x1E96, false, "h\314\261"}, {0x1E97, false, "t\314\210"}, {0x1E98, false, "w\314\212"},
+    {0x1E99, false, "y\314\212"}, {0x1E9A, true, "a\312\276"}, {0x1E9B, false, "\305\277\314\207"}, {0x1EA0, false, "A\314\243"},
+    {0x1EA1, false, "a\314\243"}, {0x1EA2, false, "A\314\211"}, {0x1EA3, false, "a\314\211"}, {0x1EA4, false, "A\314\202\314\201"},
+    {0x1EA5, false, "a\314\202\314\201"}, {0x1EA6, false, "A\314\202\314\200"}, {0x1EA7, false, "a\314\202\314\200"}, {0x1EA8, false, "A\314\202\314\211"},
+    {0x1EA9, false, "a\314\202\314\211"}, {0x1EAA, false, "A\314\202\314\203"}, {0x1EAB, false, "a\314\202\314\203"}, {0x1EAC, false, "A\314\243\314\202"},
+    {0x1EAD, false, "a\314\243\314\202"}, {0x1EAE, false, "A\314\206\314\201"}, {0x1EAF, false, "a\314\206\314\201"}, {0x1EB0, false, "A\314\206\314\200"},
+    {0x1EB1, false, "a\314\206\314\200"}, {0x1EB2, false, "A\314\206\314\211"}, {0x1EB3, false, "a\314\206\314\211"}, {0x1EB4, false, "A\314\206\314\203"},
+    {0x1EB5, false, "a\314\206\314\203"}, {0x1EB6, false, "A\314\243\314\206"}, {0x1EB7, false, "a\314\243\314\206"}, {0x1EB8, false, "E\314\243"},
+    {0x1EB9, false, "e\314\243"}, {0x1EBA, false, "E\314\211"}, {0x1EBB, false, "e\314\211"}, {0x1EBC, false, "E\314\203"},
+    {0x1EBD, false, "e\314\203"}, {0x1EBE, false, "E\314\202\314\201"}, {0x1EBF, false, "e\314\202\314\201"}, {0x1EC0, false, "E\314\202\314\200"},
+    {0x1EC1, false, "e\314\202\314\200"}, {0x1EC2, false, "E\314\202\314\211"}, {0x1EC3, false, "e\314\202\314\211"}, {0x1EC4, false, "E\314\202\314\203"},
+    {0x1EC5, false, "e\314\202\314\203"}, {0x1EC6, false, "E\314\243\314\202"}, {0x1EC7, false, "e\314\243\314\202"}, {0x1EC8, false, "I\314\211"},
+    {0x1EC9, false, "i\314\211"}, {0x1ECA, false, "I\314\243"}, {0x1ECB, false, "i\314\243"}, {0x1ECC, false, "O\314\243"},
+    {0x1ECD, false, "o\314\243"}, {0x1ECE, false, "O\314\211"}, {0x1ECF, false, "o\314\211"}, {0x1ED0, false, "O\314\202\314\201"},
+    {0x1ED1, false, "o\314\202\314\201"}, {0x1ED2, false, "O\314\202\314\200"}, {0x1ED3, false, "o\314\202\314\200"}, {0x1ED4, false, "O\314\202\314\211"},
+    {0x1ED5, false, "o\314\202\314\211"}, {0x1ED6, false, "O\314\202\314\203"}, {0x1ED7, false, "o\314\202\314\203"}, {0x1ED8, false, "O\314\243\314\202"},
+    {0x1ED9, false, "o\314\243\314\202"}, {0x1EDA, false, "O\314\233\314\201"}, {0x1EDB, false, "o\314\233\314\201"}, {0x1EDC, false, "O\314\233\314\200"},
+    {0x1EDD, false, "o\314\233\314\200"}, {0x1EDE, false, "O\314\233\314\211"}, {0x1EDF, false, "o\314\233\314\211"}, {0x1EE0, false, "O\314\233\314\203"},
+    {0x1EE1, false, "o\314\233\314\203"}, {0x1EE2, false, "O\314\233\314\243"}, {0x1EE3, false, "o\314\233\314\243"}, {0x1EE4, false, "U\314\243"},
+    {0x1EE5, false, "u\314\243"}, {0x1EE6, false, "U\314\211"}, {0x1EE7, false, "u\314\211"}, {0x1EE8, false, "U\314\233\314\201"},
+    {0x1EE9, false, "u\314\233\314\201"}, {0x1EEA, false, "U\314\233\314\200"}, {0x1EEB, false, "u\314\233\314\200"}, {0x1EEC, false, "U\314\233\314\211"},
+    {0x1EED, false, "u\314\233\314\211"}, {0x1EEE, false, "U\314\233\314\203"}, {0x1EEF, false, "u\314\233\314\203"}, {0x1EF0, false, "U\314\233\314\243"},
+    {0x1EF1, false, "u\314\233\314\243"}, {0x1EF2, false, "Y\314\200"}, {0x1EF3, false, "y\314\200"}, {0x1EF4, false, "Y\314\243"},
+    {0x1EF5, false, "y\314\243"}, {0x1EF6, false, "Y\314\211"}, {0x1EF7, false, "y\314\211"}, {0x1EF8, false, "Y\314\203"},
+    {0x1EF9, false, "y\314\203"}, {0x2000, false, "\342\200\202"}, {0x2001, false, "\342\200\203"}, {0x2002, true, " "},
+    {0x2003, true, " "}, {0x2004, true, " "}, {0x2005, true, " "}, {0x2006, true, " "},
+    {0x2007, true, " "}, {0x2008, true, " "}, {0x2009, true, " "}, {0x200A, true, " "},
+    {0x2011, true, "\342\200\220"}, {0x2017, true, " \314\263"}, {0x2024, true, "."}, {0x2025, true, ".."},
+    {0x2026, true, "..."}, {0x202F, true, " "}, {0x2033, true, "\342\200\262\342\200\262"}, {0x2034, true, "\342\200\262\342\200\262\342\200\262"},
+    {0x2036, true, "\342\200\265\342\200\265"}, {0x2037, true, "\342\200\265\342\200\265\342\200\265"}, {0x203C, true, "!!"}, {0x203E, true, " \314\205"},
+    {0x2047, true, "\077\077"}, {0x2048, true, "\077!"}, {0x2049, true, "!\077"}, {0x2057, true, "\342\200\262\342\200\262\342\200\262\342\200\262"},
+    {0x205F, true, " "}, {0x2070, true, "0"}, {0x2071, true, "i"}, {0x2074, true, "4"},
+    {0x2075, true, "5"}, {0x2076, true, "6"}, {0x2077, true, "7"}, {0x2078, true, "8"},
+    {0x2079, true, "9"}, {0x207A, true, "+"}, {0x207B, true, "\342\210\222"}, {0x207C, true, "="},
+    {0x207D, true, "("}, {0x207E, true, ")"}, {0x207F, true, "n"}, {0x2080, true, "0"},
+    {0x2081, true, "1"}, {0x2082, true, "2"}, {0x2083, true, "3"}, {0x2084, true, "4"},
+    {0x2085, true, "5"}, {0x2086, true, "6"}, {0x2087, true, "7"}, {0x2088, true, "8"},
+    {0x2089, true, "9"}, {0x208A, true, "+"}, {0x208B, true, "\342\210\222"}, {0x208C, true, "="},
+    {0x208D, true, "("}, {0x208E, true, ")"}, {0x2090, true, "a"}, {0x2091, true, "e"},
+    {0x2092, true, "o"}, {0x2093, true, "x"}, {0x2094, true, "\311\231"}, {0x2095, true, "h"},
+    {0x2096, true, "k"}, {0x2097, true, "l"}, {0x2098, true, "m"}, {0x2099, true, "n"},
+    {0x209A, true, "p"}, {0x209B, true, "s"}, {0x209C, true, "t"}, {0x2100, true, "a/c"},
+    {0x2101, true, "a/s"}, {0x2102, true, "C"}, {0x2103, true, "\302\260C"}, {0x2105, true, "c/o"},
+    {0x2106, true, "c/u"}, {0x2107, true, "\306\220"}, {0x2109, true, "\302\260F"}, {0x210A, true, "g"},
+    {0x210B, true, "H"}, {0x210C, true, "H"}, {0x210D, true, "H"}, {0x210E, true, "h"},
+    {0x210F, true, "\304\247"}, {0x2110, true, "I"}, {0x2111, true, "I"}, {0x2112, true, "L"},
+    {0x2113, true, "l"}, {0x2115, true, "N"}, {0x2116, true, "No"}, {0x2119, true, "P"},
+    {0x211A, true, "Q"}, {0x211B, true, "R"}, {0x211C, true, "R"}, {0x211D, true, "R"},
+    {0x2120, true, "SM"}, {0x2121, true, "TEL"}, {0x2122, true, "TM"}, {0x2124, true, "Z"},
+    {0x2126, false, "\316\251"}, {0x2128, true, "Z"}, {0x212A, false, "K"}, {0x212B, false, "A\314\212"},
+    {0x212C, true, "B"}, {0x212D, true, "C"}, {0x212F, true, "e"}, {0x2130, true, "E"},
+    {0x2131, true, "F"}, {0x2133, true, "M"}, {0x2134, true, "o"}, {0x2135, true, "\327\220"},
+    {0x2136, true, "\327\221"}, {0x2137, true, "\327\222"}, {0x2138, true, "\327\223"}, {0x2139, true, "i"},
+    {0x213B, true, "FAX"}, {0x213C, true, "\317\200"}, {0x213D, true, "\316\263"}, {0x213E, true, "\316\223"},
+    {0x213F, true, "\316\240"}, {0x2140, true, "\342\210\221"}, {0x2145, true, "D"}, {0x2146, true, "d"},
+    {0x2147, true, "e"}, {0x2148, true, "i"}, {0x2149, true, "j"}, {0x2150, true, "1\342\201\2047"},
+    {0x2151, true, "1\342\201\2049"}, {0x2152, true, "1\342\201\20410"}, {0x2153, true, "1\342\201\2043"}, {0x2154, true, "2\342\201\2043"},
+    {0x2155, true, "1\342\201\2045"}, {0x2156, true, "2\342\201\2045"}, {0x2157, true, "3\342\201\2045"}, {0x2158, true, "4\342\201\2045"},
+    {0x2159, true, "1\342\201\2046"}, {0x215A, true, "5\342\201\2046"}, {0x215B, true, "1\342\201\2048"}, {0x215C, true, "3\342\201\2048"},
+    {0x215D, true, "5\342\201\2048"}, {0x215E, true, "7\342\201\2048"}, {0x215F, true, "1\342\201\204"}, {0x2160, true, "I"},
+    {0x2161, true, "II"}, {0x2162, true, "III"}, {0x2163, true, "IV"}, {0x2164, true, "V"},
+    {0x2165, true, "VI"}, {0x2166, true, "VII"}, {0x2167, true, "VIII"}, {0x2168, true, "IX"},
+    {0x2169, true, "X"}, {0x216A, true, "XI"}, {0x216B, true, "XII"}, {0x216C, true, "L"},
+    {0x216D, true, "C"}, {0x216E, true, "D"}, {0x216F, true, "M"}, {0x2170, true, "i"},
+    {0x2171, true, "ii"}, {0x2172, true, "iii"}, {0x2173, true, "iv"}, {0x2174, true, "v"},
+    {0x2175, true, "vi"}, {0x2176, true, "vii"}, {0x2177, true, "viii"}, {0x2178, true, "ix"},
+    {0x2179, true, "x"}, {0x217A, true, "xi"}, {0x217B, true, "xii"}, {0x217C, true, "l"},
+    {0x217D, true, "c"}, {0x217E, true, "d"}, {0x217F, true, "m"}, {0x2189, true, "0\342\201\2043"},
+    {0xFB00, true, "ff"}, {0xFB01, true, "fi"}, {0xFB02, true, "fl"}, {0xFB03, true, "ffi"},
+    {0xFB04, true, "ffl"}, {0xFB05, true, "st"}, {0xFB06, true, "st"},
+};
+constexpr folding_t foldings[] = {
+    {0x00B5, "\316\274"}, {0x00C6, "\303\246"}, {0x00D0, "\303\260"}, {0x00D8, "\303\270"}, {0x00DE, "\303\276"}, {0x00DF, "ss"},
+    {0x0110, "\304\221"}, {0x0126, "\304\247"}, {0x0132, "\304\263"}, {0x013F, "\305\200"}, {0x0141, "\305\202"}, {0x0149, "\312\274n"},
+    {0x014A, "\305\213"}, {0x0152, "\305\223"}, {0x0166, "\305\247"}, {0x017F, "s"}, {0x0181, "\311\223"}, {0x0182, "\306\203"},
+    {0x0184, "\306\205"}, {0x0186, "\311\224"}, {0x0187, "\306\210"}, {0x0189, "\311\226"}, {0x018A, "\311\227"}, {0x018B, "\306\214"},
+    {0x018E, "\307\235"}, {0x018F, "\311\231"}, {0x0190, "\311\233"}, {0x0191, "\306\222"}, {0x0193, "\311\240"}, {0x0194, "\311\243"},
+    {0x0196, "\311\251"}, {0x0197, "\311\250"}, {0x0198, "\306\231"}, {0x019C, "\311\257"}, {0x019D, "\311\262"}, {0x019F, "\311\265"},
+    {0x01A2, "\306\243"}, {0x01A4, "\306\245"}, {0x01A6, "\312\200"}, {0x01A7, "\306\250"}, {0x01A9, "\312\203"}, {0x01AC, "\306\255"},
+    {0x01AE, "\312\210"}, {0x01B1, "\312\212"}, {0x01B2, "\312\213"}, {0x01B3, "\306\264"}, {0x01B5, "\306\266"}, {0x01B7, "\312\222"},
+    {0x01B8, "\306\271"}, {0x01BC, "\306\275"}, {0x01C4, "\307\206"}, {0x01C5, "\307\206"}, {0x01C7, "\307\211"}, {0x01C8, "\307\211"},
+    {0x01CA, "\307\214"}, {0x01CB, "\307\214"}, {0x01E4, "\307\245"}, {0x01F1, "\307\263"}, {0x01F2, "\307\263"}, {0x01F6, "\306\225"},
+    {0x01F7, "\306\277"}, {0x021C, "\310\235"}, {0x0220, "\306\236"}, {0x0222, "\310\243"}, {0x0224, "\310\245"}, {0x023A, "\342\261\245"},
+    {0x023B, "\310\274"}, {0x023D, "\306\232"}, {0x023E, "\342\261\246"}, {0x0241, "\311\202"}, {0x0243, "\306\200"}, {0x0244, "\312\211"},
+    {0x0245, "\312\214"}, {0x0246, "\311\207"}, {0x0248, "\311\211"}, {0x024A, "\311\213"}, {0x024C, "\311\215"}, {0x024E, "\311\217"},
+    {0x0370, "\315\261"}, {0x0372, "\315\263"}, {0x0376, "\315\267"}, {0x037F, "\317\263"}, {0x0391, "\316\261"}, {0x0392, "\316\262"},
+    {0x0393, "\316\263"}, {0x0394, "\316\264"}, {0x0395, "\316\265"}, {0x0396, "\316\266"}, {0x0397, "\316\267"}, {0x0398, "\316\270"},
+    {0x0399, "\316\271"}, {0x039A, "\316\272"}, {0x039B, "\316\273"}, {0x039C, "\316\274"}, {0x039D, "\316\275"}, {0x039E, "\316\276"},
+    {0x039F, "\316\277"}, {0x03A0, "\317\200"}, {0x03A1, "\317\201"}, {0x03A3, "\317\203"}, {0x03A4, "\317\204"}, {0x03A5, "\317\205"},
+    {0x03A6, "\317\206"}, {0x03A7, "\317\207"}, {0x03A8, "\317\210"}, {0x03A9, "\317\211"}, {0x03C2, "\317\203"}, {0x03CF, "\317\227"},
+    {0x03D0, "\316\262"}, {0x03D1, "\316\270"}, {0x03D5, "\317\206"}, {0x03D6, "\317\200"}, {0x03D8, "\317\231"}, {0x03DA, "\317\233"},
+    {0x03DC, "\317\235"}, {0x03DE, "\317\237"}, {0x03E0, "\317\241"}, {0x03E2, "\317\243"}, {0x03E4, "\317\245"}, {0x03E6, "\317\247"},
+    {0x03E8, "\317\251"}, {0x03EA, "\317\253"}, {0x03EC, "\317\255"}, {0x03EE, "\317\257"}, {0x03F0, "\316\272"}, {0x03F1, "\317\201"},
+    {0x03F4, "\316\270"}, {0x03F5, "\316\265"}, {0x03F7, "\317\270"}, {0x03F9, "\317\262"}, {0x03FA, "\317\273"}, {0x03FD, "\315\273"},
+    {0x03FE, "\315\274"}, {0x03FF, "\315\275"}, {0x0402, "\321\222"}, {0x0404, "\321\224"}, {0x0405, "\321\225"}, {0x0406, "\321\226"},
+    {0x0408, "\321\230"}, {0x0409, "\321\231"}, {0x040A, "\321\232"}, {0x040B, "\321\233"}, {0x040F, "\321\237"}, {0x0410, "\320\260"},
+    {0x0411, "\320\261"}, {0x0412, "\320\262"}, {0x0413, "\320\263"}, {0x0414, "\320\264"}, {0x0415, "\320\265"}, {0x0416, "\320\266"},
+    {0x0417, "\320\267"}, {0x0418, "\320\270"}, {0x041A, "\320\272"}, {0x041B, "\320\273"}, {0x041C, "\320\274"}, {0x041D, "\320\275"},
+    {0x041E, "\320\276"}, {0x041F, "\320\277"}, {0x0420, "\321\200"}, {0x0421, "\321\201"}, {0x0422, "\321\202"}, {0x0423, "\321\203"},
+    {0x0424, "\321\204"}, {0x0425, "\321\205"}, {0x0426, "\321\206"}, {0x0427, "\321\207"}, {0x0428, "\321\210"}, {0x0429, "\321\211"},
+    {0x042A, "\321\212"}, {0x042B, "\321\213"}, {0x042C, "\321\214"}, {0x042D, "\321\215"}, {0x042E, "\321\216"}, {0x042F, "\321\217"},
+    {0x0460, "\321\241"}, {0x0462, "\321\243"}, {0x0464, "\321\245"}, {0x0466, "\321\247"}, {0x0468, "\321\251"}, {0x046A, "\321\253"},
+    {0x046C, "\321\255"}, {0x046E, "\321\257"}, {0x0470, "\321\261"}, {0x0472, "\321\263"}, {0x0474, "\321\265"}, {0x0478, "\321\271"},
+    {0x047A, "\321\273"}, {0x047C, "\321\275"}, {0x047E, "\321\277"}, {0x0480, "\322\201"}, {0x048A, "\322\213"}, {0x048C, "\322\215"},
+    {0x048E, "\322\217"}, {0x0490, "\322\221"}, {0x0492, "\322\223"}, {0x0494, "\322\225"}, {0x0496, "\322\227"}, {0x0498, "\322\231"},
+    {0x049A, "\322\233"}, {0x049C, "\322\235"}, {0x049E, "\322\237"}, {0x04A0, "\322\241"}, {0x04A2, "\322\243"}, {0x04A4, "\322\245"},
+    {0x04A6, "\322\247"}, {0x04A8, "\322\251"}, {0x04AA, "\322\253"}, {0x04AC, "\322\255"}, {0x04AE, "\322\257"}, {0x04B0, "\322\261"},
+    {0x04B2, "\322\263"}, {0x04B4, "\322\265"}, {0x04B6, "\322\267"}, {0x04B8, "\322\271"}, {0x04BA, "\322\273"}, {0x04BC, "\322\275"},
+    {0x04BE, "\322\277"}, {0x04C0, "\323\217"}, {0x04C3, "\323\204"}, {0x04C5, "\323\206"}, {0x04C7, "\323\210"}, {0x04C9, "\323\212"},
+    {0x04CB, "\323\214"}, {0x04CD, "\323\216"}, {0x04D4, "\323\225"}, {0x04D8, "\323\231"}, {0x04E0, "\323\241"}, {0x04E8, "\323\251"},
+    {0x04F6, "\323\267"}, {0x04FA, "\323\273"}, {0x04FC, "\323\275"}, {0x04FE, "\323\277"}, {0x1E9A, "a\312\276"}, {0x1E9E, "ss"},
+    {0x1EFA, "\341\273\273"}, {0x1EFC, "\341\273\275"}, {0x1EFE, "\341\273\277"}, {0x2132, "\342\205\216"}, {0x2160, "\342\205\260"}, {0x2161, "\342\205\261"},
+    {0x2162, "\342\205\262"}, {0x2163, "\342\205\263"}, {0x2164, "\342\205\264"}, {0x2165, "\342\205\265"}, {0x2166, "\342\205\266"}, {0x2167, "\342\205\267"},
+    {0x2168, "\342\205\270"}, {0x2169, "\342\205\271"}, {0x216A, "\342\205\272"}, {0x216B, "\342\205\273"}, {0x216C, "\342\205\274"}, {0x216D, "\342\205\275"},
+    {0x216E, "\342\205\276"}, {0x216F, "\342\205\277"}, {0x2183, "\342\206\204"}, {0xFB00, "ff"}, {0xFB01, "fi"}, {0xFB02, "fl"},
+    {0xFB03, "ffi"}, {0xFB04, "ffl"}, {0xFB05, "st"}, {0xFB06, "st"},
+};
+
+bool is_mark(const char32_t code)
+{
+    // combining diacritical marks, which follow the letter they belong to after decomposition
+    return code >= 0x0300 && code <= 0x036F;
+}
+
+// Canonical combining class of U+0300..U+036F, from the same version of the Unicode Character Database.
+// Marks with a lower class come first in a run of marks, e.g., U+0323 (below, 220) before U+0302 (above, 230).
+constexpr std::uint8_t combining_classes[] = {
+    230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230,
+    230, 230, 230, 230, 230, 232, 220, 220, 220, 220, 232, 216, 220, 220, 220, 220,
+    220, 202, 202, 220, 220, 220, 220, 202, 202, 220, 220, 220, 220, 220, 220, 220,
+    220, 220, 220, 220, 1, 1, 1, 1, 1, 220, 220, 220, 220, 230, 230, 230,
+    230, 230, 230, 230, 230, 240, 230, 220, 220, 220, 230, 230, 230, 220, 220, 0,
+    230, 230, 230, 220, 220, 220, 220, 230, 232, 220, 220, 230, 233, 234, 234, 233,
+    234, 234, 233, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230,
+};
+
+std::uint8_t combining_class(const std::string_view out, const std::size_t pos)
+/*
+ * Return the combining class of the mark encoded at "pos" (2 bytes in UTF-8), or 0 if there is no mark.
+ */
+{
+    const auto lead = static_cast<unsigned char>(out[pos]);
+    if ((lead != 0xCC && lead != 0xCD) || pos + 1 >= out.size()) {
+        return 0;
+    }
+    const char32_t code = (static_cast<char32_t>(lead & 0x1F) << 6) | (static_cast<unsigned char>(out[pos + 1]) & 0x3F);
+    return is_mark(code) ? combining_classes[code - 0x0300] : 0;
+}
+
+void reorder_marks(std::string &out)
+/*
+ * Put every run of marks in canonical order (a stable sort by combining class), like NFC does,
+ * so "e" + U+0323 + U+0302 (decomposed "ệ") equals "e" + U+0302 + U+0323 (decomposed "ê" followed by U+0323).
+ * Runs are short, so each mark is moved back by swapping it with its neighbours in place.
+ */
+{
+    std::size_t run_begin = 0;  // first mark of the current run
+    std::size_t pos = 0;
+    while (pos < out.size()) {
+        const std::uint8_t mark = combining_class(out, pos);
+        if (mark == 0) {
+            // "out" is valid UTF-8, so the length follows from the first byte
+            const auto lead = static_cast<unsigned char>(out[pos]);
+            pos += (lead < 0x80) ? 1 : (lead < 0xE0) ? 2 : (lead < 0xF0) ? 3 : 4;
+            run_begin = pos;
+            continue;
+        }
+        for (std::size_t i = pos; i != run_begin && combining_class(out, i - 2) > mark; i -= 2) {
+            std::swap(out[i - 2], out[i]);
+            std::swap(out[i - 1], out[i + 1]);
+        }
+        pos += 2;
+    }
+}
+
+void encode(const char32_t code, std::string &out)
+/*
+ * Append a code point as UTF-8.
+ */
+{
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    }
+    else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+std::size_t next_code(const std::string_view in, const std::size_t pos, char32_t &code)
+/*
+ * Decode the code point at "pos" and return its length in bytes.
+ * Invalid bytes are returned one by one as U+DC80..U+DCFF (like Python's "surrogateescape"), so they stay distinct.
+ */
+{
+    const auto byte = static_cast<unsigned char>(in[pos]);
+    std::size_t length = 0;
+    if (byte < 0x80) {
+        code = byte;
+        return 1;
+    }
+    if ((byte & 0xE0) == 0xC0) {
+        code = byte & 0x1F;
+        length = 2;
+    }
+    else if ((byte & 0xF0) == 0xE0) {
+        code = byte & 0x0F;
+        length = 3;
+    }
+    else if ((byte & 0xF8) == 0xF0) {
+        code = byte & 0x07;
+        length = 4;
+    }
+    if (length == 0 || pos + length > in.size()) {
+        code = 0xDC00 + byte;
+        return 1;
+    }
+    for (std::size_t i = 1; i != length; ++i) {
+        const auto next = static_cast<unsigned char>(in[pos + i]);
+        if ((next & 0xC0) != 0x80) {
+            code = 0xDC00 + byte;
+            return 1;
+        }
+        code = (code << 6) | (next & 0x3F);
+    }
+    return length;
+}
+
+template <typename T>
+const T *find_entry(const T *begin, const T *end, const char32_t code)
+/*
+ * Binary search in a table sorted by code point.
+ */
+{
+    const T *itr = std::lower_bound(begin, end, code, [](const T &entry, const char32_t value) {
+        return entry.code < value;
+    });
+    return (itr != end && itr->code == code) ? itr : nullptr;
+}
+
+void append_folded(const char32_t code, const Normalizer::options_t &options, std::string &out)
+/*
+ * Append a code point that is already decomposed, applying case folding and accent stripping.
+ */
+{
+    if (options.strip_accents && is_mark(code)) {
+        return;
+    }
+    if (options.fold_case) {
+        if (code >= 'A' && code <= 'Z') {
+            out += static_cast<char>(code + ('a' - 'A'));
+            return;
+        }
+        if (const folding_t *entry = find_entry(std::begin(foldings), std::end(foldings), code)) {
+            // folded forms may contain marks too, e.g., "İ" -> "i" + U+0307
+            const std::string_view folded(entry->folded);
+            char32_t part;
+            for (std::size_t pos = 0; pos < folded.size();) {
+                pos += next_code(folded, pos, part);
+                if (!(options.strip_accents && is_mark(part))) {
+                    encode(part, out);
+                }
+            }
+            return;
+        }
+    }
+    encode(code, out);
+}
+
+}  // namespace
+
+namespace Normalizer {
+
+bool parse_options(const std::string &list, options_t &options)
+/*
+ * Read a comma-separated list of normalizations, e.g., "case,accents".
+ * Known names are "nfc", "nfkc", "case" and "accents"; every normalization implies "nfc".
+ *
+ * Return True if succeeded, False if a name is unknown.
+ */
+{
+    options = options_t();
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item == "nfc") {
+            options.canonical = true;
+        }
+        else if (item == "nfkc") {
+            options.canonical = true;
+            options.compatibility = true;
+        }
+        else if (item == "case") {
+            options.canonical = true;
+            options.fold_case = true;
+        }
+        else if (item == "accents") {
+            options.canonical = true;
+            options.strip_accents = true;
+        }
+        else {
+            return false;
+        }
+    }
+    return options.canonical;
+}
+
+bool is_enabled(const options_t &options)
+{
+    return options.canonical;
+}
+
+void normalize(const std::string_view in, const options_t &options, std::string &out)
+/*
+ * Write the normalized form of "in" to "out", in a single pass.
+ * "out" is cleared first and keeps its capacity, so reusing it avoids allocations.
+ *
+ * The result is only meant for comparisons: letters are fully decomposed instead of composed (and their marks
+ * put in canonical order), which makes the same strings equal as NFC (or NFKC) would, without needing composition tables.
+ */
+{
+    out.clear();
+    bool ascii = true;  // marks can only appear after a non-ASCII character, so ASCII keys skip reordering
+    std::size_t pos = 0;
+    while (pos < in.size()) {
+        const auto byte = static_cast<unsigned char>(in[pos]);
+        // ASCII never decomposes, so most keys take this path only
+        if (byte < 0x80) {
+            out += (options.fold_case && byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte + ('a' - 'A')) : static_cast<char>(byte);
+            ++pos;
+            continue;
+        }
+        ascii = false;
+        char32_t code;
+        pos += next_code(in, pos, code);
+        // fullwidth ASCII ("Ａ") is a fixed offset away from ASCII
+        if (options.compatibility && code >= 0xFF01 && code <= 0xFF5E) {
+            append_folded(code - 0xFEE0, options, out);
+            continue;
+        }
+        const decomposition_t *entry = find_entry(std::begin(decompositions), std::end(decompositions), code);
+        if (entry == nullptr || (entry->compatibility && !options.compatibility)) {
+            append_folded(code, options, out);
+            continue;
+        }
+        const std::string_view decomposed(entry->decomposed);
+        char32_t part;
+        for (std::size_t part_pos = 0; part_pos < decomposed.size();) {
+            part_pos += next_code(decomposed, part_pos, part);
+            append_folded(part, options, out);
+        }
+    }
+    if (!ascii && !options.strip_accents) {
+        reorder_marks(out);
+    }
+}
+
+void decode(const std::string_view in, std::u32string &out)
+/*
+ * Write the code points of "in" to "out", so edit distances count characters instead of bytes.
+ */
+{
+    out.clear();
+    char32_t code;
+    for (std::size_t pos = 0; pos < in.size();) {
+        pos += next_code(in, pos, code);
+        out += code;
+    }
+}
+
+}  // namespace Normalizer
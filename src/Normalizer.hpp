@@ -0,0 +1,24 @@
+#pragma once
+
+// libraries
+#include <string>
+#include <string_view>
+
+// custom namespace
+namespace Normalizer {
+
+// types
+struct options_t {
+    bool canonical = false;      // composed and decomposed letters are equal, e.g., "é" and "e" + U+0301 (NFC)
+    bool compatibility = false;  // ligatures, fullwidth letters, superscripts etc. are replaced with plain letters (NFKC)
+    bool fold_case = false;      // "Straße" and "STRASSE" are equal
+    bool strip_accents = false;  // "café" and "cafe" are equal
+};
+
+// prototypes
+bool parse_options(const std::string &list, options_t &options);
+bool is_enabled(const options_t &options);
+void normalize(const std::string_view in, const options_t &options, std::string &out);
+void decode(const std::string_view in, std::u32string &out);
+
+}  // namespace Normalizer
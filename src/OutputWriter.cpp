@@ -0,0 +1,353 @@
+#include "OutputWriter.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr char binary_magic[8] = {'C', 'S', 'V', 'V', 'R', 'O', 'W', '1'};
+
+bool is_json_number(const std::string_view text)
+/*
+ * Return True if "text" is a number in JSON syntax (e.g., not "+1", "01" or ".5"), False otherwise.
+ */
+{
+    std::size_t pos = 0;
+    const auto digits = [&]() {
+        const std::size_t begin = pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            ++pos;
+        }
+        return pos - begin;
+    };
+    if (pos < text.size() && text[pos] == '-') {
+        ++pos;
+    }
+    const std::size_t integer_begin = pos;
+    const std::size_t integer_digits = digits();
+    if (integer_digits == 0 || (integer_digits > 1 && text[integer_begin] == '0')) {
+        return false;
+    }
+    if (pos < text.size() && text[pos] == '.') {
+        ++pos;
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+        ++pos;
+        if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+            ++pos;
+        }
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    return pos == text.size();
+}
+
+}  // namespace
+
+namespace OutputWriter {
+
+Writer::Writer(const std::string &filename, const format_t format, const bool append)
+/*
+ * Class constructor.
+ *
+ * Open (and truncate, unless "append" is set) "filename" for writing rows in "format".
+ * When appending, the header is only used to name the columns, it isn't written again.
+ */
+    : writer(filename, append), format(format), append(append)
+{
+}
+
+void Writer::write_header(const std::vector<std::string_view> &names, const std::vector<Schema::type_t> &types, const std::string_view raw)
+/*
+ * Write the names of the columns; "types" decide which values of "jsonl" are written as numbers (may be empty).
+ * "raw" is the header as it appears in the input, only used by "raw" (see "write_row()"), which also ends
+ * the last row with the header's line terminator if the input doesn't end with one.
+ *
+ * "jsonl" has no header line, every row repeats the names instead.
+ * "binary" begins with the magic bytes "CSVVROW1", followed by the amount of columns and every name,
+ * and every row is one value per column; numbers are 32-bit unsigned integers in native byte order,
+ * and every name and value is its length followed by its bytes.
+ */
+{
+    // a string literal has a stable address, so it can be passed to "write_view()"
+    if (raw.size() >= 2 && raw.substr(raw.size() - 2) == "\r\n") {
+        this->line_end = "\r\n";
+    }
+    this->keys.assign(names.begin(), names.end());
+    this->numeric.assign(names.size(), false);
+    for (std::size_t i = 0; i != names.size() && i != types.size(); ++i) {
+        this->numeric[i] = types[i] != Schema::type_t::text;
+    }
+    if (this->append) {
+        return;
+    }
+    switch (this->format) {
+    case format_t::jsonl:
+        break;
+    case format_t::binary:
+        this->writer.write(std::string_view(binary_magic, sizeof(binary_magic)));
+        this->write_length(names.size());
+        this->write_binary(names);
+        break;
+    default:
+        this->write_row(names, raw);
+        break;
+    }
+}
+
+void Writer::write_header(const CsvReader::RowStore &header, const std::vector<Schema::type_t> &types, const std::string_view raw)
+/*
+ * Same as above, but for the header row of the input.
+ */
+{
+    std::vector<std::string_view> names;
+    for (std::size_t i = 0; i != header.field_count(0); ++i) {
+        names.push_back(header.field(0, i));
+    }
+    this->write_header(names, types, raw);
+}
+
+void Writer::write_row(const std::vector<std::string_view> &values, const std::string_view raw)
+/*
+ * Write a single row. "raw" is the row as it appears in the input, including its line terminator if it has one;
+ * "raw" copies it without touching its bytes (see "DiskManager::BufferedWriter::write_view()"),
+ * so it must stay valid until "flush()". Rows without it are written like "csv".
+ */
+{
+    switch (this->format) {
+    case format_t::raw:
+        if (!raw.empty()) {
+            this->writer.write_view(raw);
+            if (raw.back() != '\n') {
+                this->writer.write_view(this->line_end);
+            }
+            return;
+        }
+        this->write_csv(values);
+        return;
+    case format_t::csv:
+        this->write_csv(values);
+        return;
+    case format_t::tsv:
+        this->write_tsv(values);
+        return;
+    case format_t::jsonl:
+        this->write_jsonl(values);
+        return;
+    case format_t::binary:
+        this->write_binary(values);
+        return;
+    }
+}
+
+void Writer::write_row(const CsvReader::RowStore &store, const std::size_t row, const std::string_view raw)
+/*
+ * Same as above, but for a stored row.
+ */
+{
+    this->row_values.clear();
+    // the original bytes are all "raw" needs
+    if (this->format != format_t::raw || raw.empty()) {
+        for (std::size_t i = 0; i != store.field_count(row); ++i) {
+            this->row_values.push_back(store.field(row, i));
+        }
+    }
+    this->write_row(this->row_values, raw);
+}
+
+bool Writer::flush()
+{
+    return this->writer.flush();
+}
+
+std::size_t Writer::bytes_written() const
+{
+    return this->writer.bytes_written();
+}
+
+void Writer::write_csv(const std::vector<std::string_view> &values)
+/*
+ * Write comma-separated values, quoting those that contain a comma, a quote or a line break (quotes are doubled).
+ */
+{
+    for (std::size_t i = 0; i != values.size(); ++i) {
+        if (i != 0) {
+            this->writer.put(',');
+        }
+        const std::string_view value = values[i];
+        if (value.find_first_of(",\"\n\r") == std::string_view::npos) {
+            this->writer.write(value);
+            continue;
+        }
+        this->writer.put('"');
+        std::size_t begin = 0;
+        for (std::size_t quote = value.find('"'); quote != std::string_view::npos; quote = value.find('"', quote + 1)) {
+            this->writer.write(value.substr(begin, quote + 1 - begin));
+            this->writer.put('"');
+            begin = quote + 1;
+        }
+        this->writer.write(value.substr(begin));
+        this->writer.put('"');
+    }
+    this->writer.put('\n');
+}
+
+void Writer::write_tsv(const std::vector<std::string_view> &values)
+{
+    for (std::size_t i = 0; i != values.size(); ++i) {
+        if (i != 0) {
+            this->writer.put('\t');
+        }
+        for (const char c : values[i]) {
+            switch (c) {
+            case '\t':
+                this->writer.write("\\t");
+                break;
+            case '\n':
+                this->writer.write("\\n");
+                break;
+            case '\r':
+                this->writer.write("\\r");
+                break;
+            case '\\':
+                this->writer.write("\\\\");
+                break;
+            default:
+                this->writer.put(c);
+                break;
+            }
+        }
+    }
+    this->writer.put('\n');
+}
+
+void Writer::write_jsonl(const std::vector<std::string_view> &values)
+/*
+ * Write a JSON object keyed by the header. Values of numeric columns that are valid JSON numbers are written as such,
+ * empty ones as "null", and everything else as a string.
+ */
+{
+    this->writer.put('{');
+    for (std::size_t i = 0; i != values.size(); ++i) {
+        if (i != 0) {
+            this->writer.put(',');
+        }
+        if (i < this->keys.size()) {
+            this->write_json_string(this->keys[i]);
+        }
+        else {
+            // columns without a name are referred to like in "--where", e.g., "#3"
+            this->writer.write("\"#");
+            this->writer.write(std::to_string(i));
+            this->writer.put('"');
+        }
+        this->writer.put(':');
+        const bool numeric = i < this->numeric.size() && this->numeric[i];
+        if (numeric && values[i].empty()) {
+            this->writer.write("null");
+        }
+        else if (numeric && is_json_number(values[i])) {
+            this->writer.write(values[i]);
+        }
+        else {
+            this->write_json_string(values[i]);
+        }
+    }
+    this->writer.write("}\n");
+}
+
+void Writer::write_json_string(const std::string_view value)
+/*
+ * Write "value" as a JSON string; quotes, backslashes and control characters are escaped, everything else is copied.
+ */
+{
+    static constexpr char hex[] = "0123456789abcdef";
+    this->writer.put('"');
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i != value.size(); ++i) {
+        const auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        this->writer.write(value.substr(begin, i - begin));
+        begin = i + 1;
+        switch (c) {
+        case '"':
+            this->writer.write("\\\"");
+            break;
+        case '\\':
+            this->writer.write("\\\\");
+            break;
+        case '\n':
+            this->writer.write("\\n");
+            break;
+        case '\r':
+            this->writer.write("\\r");
+            break;
+        case '\t':
+            this->writer.write("\\t");
+            break;
+        default:
+            this->writer.write("\\u00");
+            this->writer.put(hex[c >> 4]);
+            this->writer.put(hex[c & 0xf]);
+            break;
+        }
+    }
+    this->writer.write(value.substr(begin));
+    this->writer.put('"');
+}
+
+void Writer::write_binary(const std::vector<std::string_view> &values)
+{
+    for (const std::string_view value : values) {
+        this->write_length(value.size());
+        this->writer.write(value);
+    }
+}
+
+void Writer::write_length(const std::size_t length)
+{
+    const auto value = static_cast<std::uint32_t>(length);
+    char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    this->writer.write(std::string_view(bytes, sizeof(bytes)));
+}
+
+bool parse_format(const std::string &name, format_t &format)
+/*
+ * Parse the name of an output format: "raw", "csv", "tsv", "jsonl" or "binary".
+ *
+ * Return True if succeeded, False if the name is unknown.
+ */
+{
+    for (const format_t candidate : {format_t::raw, format_t::csv, format_t::tsv, format_t::jsonl, format_t::binary}) {
+        if (name == format_name(candidate)) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *format_name(const format_t format)
+{
+    switch (format) {
+    case format_t::csv:
+        return "csv";
+    case format_t::tsv:
+        return "tsv";
+    case format_t::jsonl:
+        return "jsonl";
+    case format_t::binary:
+        return "binary";
+    case format_t::raw:
+        break;
+    }
+    return "raw";
+}
+
+}  // namespace OutputWriter
@@ -0,0 +1,56 @@
+#pragma once
+
+// libraries
+#include "CsvReader.hpp"
+#include "DiskManager.hpp"
+#include "Schema.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace OutputWriter {
+
+// types
+enum class format_t {
+    raw,     // rows exactly as they appear in the input, including their line terminators
+    csv,     // comma-separated, fields are quoted only if they need to be
+    tsv,     // tab-separated, tabs, newlines and backslashes are escaped as "\t", "\n" and "\\"
+    jsonl,   // one JSON object per row, keyed by the header
+    binary,  // length-prefixed fields, see "Writer::write_header()"
+};
+
+class Writer {
+  public:
+    Writer(const std::string &filename, const format_t format, const bool append = false);
+
+    void write_header(const std::vector<std::string_view> &names, const std::vector<Schema::type_t> &types, const std::string_view raw = {});
+    void write_header(const CsvReader::RowStore &header, const std::vector<Schema::type_t> &types, const std::string_view raw = {});
+    void write_row(const std::vector<std::string_view> &values, const std::string_view raw = {});
+    void write_row(const CsvReader::RowStore &store, const std::size_t row, const std::string_view raw = {});
+    bool flush();
+    std::size_t bytes_written() const;
+
+  private:
+    DiskManager::BufferedWriter writer;
+    format_t format;
+    bool append;
+    std::vector<std::string> keys;             // names of the columns, only used by "jsonl"
+    std::vector<bool> numeric;                 // columns whose values are written as JSON numbers if they are valid ones
+    std::vector<std::string_view> row_values;  // reused between rows of a "RowStore"
+    std::string_view line_end = "\n";          // ends rows whose raw bytes have no terminator, "\r\n" if the header has one
+
+    void write_csv(const std::vector<std::string_view> &values);
+    void write_tsv(const std::vector<std::string_view> &values);
+    void write_jsonl(const std::vector<std::string_view> &values);
+    void write_binary(const std::vector<std::string_view> &values);
+    void write_json_string(const std::string_view value);
+    void write_length(const std::size_t length);
+};
+
+// prototypes
+bool parse_format(const std::string &name, format_t &format);
+const char *format_name(const format_t format);
+
+}  // namespace OutputWriter
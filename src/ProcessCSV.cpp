@@ -1,160 +1,195 @@
 #include "ProcessCSV.hpp"
+#include "Aggregate.hpp"
+#include "Checkpoint.hpp"
+#include "ColumnCache.hpp"
+#include "ColumnIndex.hpp"
 #include "ConsoleInput.hpp"
+#include "CsvReader.hpp"
 #include "DiskManager.hpp"
-#include "parser.hpp"  // Author: https://github.com/AriaFallah/csv-parser
-#include <fstream>
-#include <iostream>
+#include "InputStream.hpp"
+#include "Logger.hpp"
+#include "OutputWriter.hpp"
+#include "Query.hpp"
+#include "Scan.hpp"
+#include "Schema.hpp"
+#include "Stats.hpp"
+#include "StructuralScanner.hpp"
+#include "WordMatcher.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <thread>
+#include <utility>
 #include <vector>
 
-using namespace aria::csv;
+struct matches_t {
+    CsvReader::RowStore rows;        // copies of matching rows, so writing them doesn't need to parse the input again
+    std::vector<std::size_t> words;  // target word of each row in "rows"
+    std::vector<std::size_t> first;  // row in "rows" of the first match of each target word, "npos" if none
+                                     // ("found_earlier" if an earlier run found it, see "--incremental")
+    Aggregate::Table totals;         // only used by "--aggregate", which doesn't keep any rows
+};
+
+constexpr std::size_t found_earlier = WordMatcher::Matcher::npos - 1;
+
+struct reject_t {
+    std::size_t offset;  // byte offset of the row in the input
+    std::size_t line;    // line of the row in the input, counting from 1 (quoted newlines count too)
+    std::string bytes;   // entire row as it appears in the input, without the line terminator
+};
+
+struct rejects_t {
+    std::uint64_t count = 0;    // rows whose amount of columns is not equal to the header's
+    std::vector<reject_t> rows;  // only kept if a job saves them ("--rejects")
+};
 
 class WordsHelper {
   private:
-    // types
-    using vec_temp_t = std::vector<std::string>;
-    using vec_csv_t = std::vector<std::vector<std::string>>;
-
     // variables
     ConsoleInput::console_args_t args;
-    std::string result;
+    std::optional<WordMatcher::Matcher> matcher;
+    Query::Predicate where;     // compiled "--where", empty if rows aren't filtered
+    Aggregate::Table aggregate;  // parsed "--aggregate", empty if rows are saved instead
+    std::vector<Schema::type_t> types;  // column types after "--schema", which "--format jsonl" writes numbers by
+    std::uint64_t settings = 0;  // hash of the target words and options, only used by "--incremental"
+    std::size_t rows_begin = 0;  // rows before this offset were processed by an earlier run ("--incremental")
+    std::size_t rows_end = WordMatcher::Matcher::npos;  // rows from this offset on are left for a later run
+    bool resumed = false;        // True if new matches are appended to the output of an earlier run
 
-    bool words_to_vec(vec_temp_t &v) const
+    bool load_word_list(DiskManager::LineFile &words) const
     {
         /*
-         * Load a list of target words from disk and save them to a vector.
+         * Map the list of target words into memory, one view per word.
          *
          * Return True if succeeded, False if failed.
          */
         // invalid path or wrong permissions
-        if (!DiskManager::load_words_from_disk(this->args, v)) {
-            std::cerr << "ERROR: cannot open words file: '" << this->args.filename_words
-                      << "'.\n";
+        if (!DiskManager::load_words_from_disk(this->args, words)) {
+            Logger::error() << "cannot open words file: '" << this->args.filename_words
+                            << "'.";
             return false;
         }
-        std::cout << "INFO: loaded '" << v.size()
-                  << "' target words from '" << this->args.filename_words << "'.\n";
+        const std::vector<std::string_view> &v = words.get_lines();
+        Logger::info() << "loaded '" << v.size()
+                       << "' target words from '" << this->args.filename_words << "'.";
         if (this->args.verbose) {
-            std::cout << "DEBUG: here are all the words:\n";
+            // a single message, so the list isn't interleaved with messages from other threads
+            Logger::Line line = Logger::debug();
+            line << "here are all the words:";
             for (const auto &word : v) {
-                std::cout << "'" << word << "'\n";
+                line << "\n'" << word << "'";
             }
         }
         return true;
     }
 
-    bool process_csv(vec_csv_t &v, std::size_t &header_len) const
+    void print_missing() const
     {
         /*
-         * Find a list of target words inside CSV and return them as a vector of vectors.
+         * Print all target words that were not found.
+         */
+        Logger::Line line = Logger::warning();
+        line << "couldn't find matches for the following words:";
+        const std::vector<std::size_t> missing = this->matcher->missing();
+        for (std::size_t i = 0; i != missing.size(); ++i) {
+            line << '\n' << (i + 1) << ". '" << this->matcher->word(missing[i]) << "'";
+        }
+    }
+
+    std::string_view original_row(const std::string_view data, const CsvReader::RowStore &store, const std::size_t row) const
+    {
+        /*
+         * Return a stored row as it appears in the input (including its "\n" or "\r\n"), so "--format raw" can copy it.
+         * Mapped input ("data") is read at the row's offset; otherwise, the store's own copy is used, if it kept one.
+         */
+        if (data.empty()) {
+            return store.raw(row);
+        }
+        return data.substr(store.offset(row), store.raw_size(row));
+    }
+
+    bool finish(OutputWriter::Writer &writer) const
+    {
+        /*
+         * Flush the output CSV and report the words that were not found.
          *
          * Return True if succeeded, False if failed.
          */
-        vec_temp_t vec_target_words;
-        if (!words_to_vec(vec_target_words)) {
-            std::cerr << "ERROR: failed to extract target words file: '" << this->args.filename_words
-                      << "'.\n";
-            return false;
+        const bool final_result = writer.flush();
+        if (this->args.verbose) {
+            Logger::info() << "save to disk status: " << (final_result ? "success" : "failure")
+                           << " ('" << writer.bytes_written() << "' bytes).";
+        }
+        if (!this->matcher->all_found()) {
+            this->print_missing();
+            Logger::warning() << "output CSV was saved anyway, despite the '"
+                              << (this->matcher->size() - this->matcher->found_count())
+                              << "' missing words.";
+        }
+        if (final_result) {
+            Logger::info() << "CSV file was processed successfully, see '"
+                           << this->args.filename_output << "'.";
+        }
+        return final_result;
+    }
+
+    bool save_totals(const CsvReader::RowStore &header, const std::vector<const matches_t *> &chunk_matches)
+    {
+        /*
+         * Merge the totals of all chunks and save one row per found target word, in the order of the words file.
+         * The first column is the target word, followed by one column per aggregate.
+         *
+         * Return True if succeeded, False if failed.
+         */
+        const Stats::PhaseTimer timer(Stats::phase_t::write);
+        WordMatcher::Matcher &matcher = *this->matcher;
+        const std::size_t word_amount_total = matcher.size();  // total amount of unique words
+        Aggregate::Table totals = chunk_matches[0]->totals;
+        for (std::size_t i = 1; i < chunk_matches.size(); ++i) {
+            totals.merge(chunk_matches[i]->totals);
         }
-        // open CSV using external library
-        std::ifstream file(this->args.filename_csv);
-        CsvParser parser(file);
-        vec_temp_t vec_temp;
-        // append header (doing this separately to prevent bool checks for the following rows)
-        for (const auto &row : parser) {
-            for (const auto &column : row) {
-                if (this->args.verbose) {
-                    // only used when verbose, so it's ok to use for-each loop
-                    // and get iterator separately
-                    auto i = &column - &row[0];  // get iterator
-                    std::cout << "Header column no. " << i << " = '" << column << "'\n";
-                }
-                vec_temp.push_back(column);
-                ++header_len;
-            }
-            // break after 1 row
-            break;
-        }
-        // check if requrested column index is out CSV's of bounds
-        if (this->args.word_column_idx > header_len) {
-            std::cerr << "ERROR: the target column index '"
-                      << this->args.word_column_idx
-                      << "' is larger than the total amount of columns '"
-                      << header_len
-                      << "'. Please enter a number using '--column' that "
-                         "is smaller than '"
-                      << header_len << "'.\n";
+        std::uint64_t rows_total = 0;
+        for (std::size_t word_idx = 0; word_idx != word_amount_total; ++word_idx) {
+            rows_total += totals.rows(word_idx);
+        }
+        if (rows_total == 0) {
+            this->print_missing();
+            Logger::error() << "output CSV will not be saved, "
+                               "because '0' words were found.";
             return false;
         }
-        v.push_back(vec_temp);
-        // search for rows
-        vec_temp_t::size_type word_amount_found = 0;
-        const vec_temp_t::size_type word_amount_total = vec_target_words.size();  // total amount of words
-        for (const auto &row : parser) {
-            // if no more target words, stop; prevents looping over entire csv
-            if (vec_target_words.empty()) {
-                break;
-            }
-            // dynamically check all target words against the column at target idx
-            // they will be removed when found; when no words are left, break out of the loop
-            vec_temp_t::iterator itr = vec_target_words.begin();
-            while (itr != vec_target_words.end()) {
-                if (this->args.verbose) {
-                    // this is really wordy, but ensures that the user knows what's going on
-                    std::cout << "DEBUG: checking if target word '" << *itr
-                              << "' is equal to the word at column no. '"
-                              << this->args.word_column_idx << "', which, based on the index, is equal to '"
-                              << row.at(this->args.word_column_idx) << "'.\n";
-                }
-                // if matches the word at that specific column (e.g., column 1 is "ability")
-                if (*itr == row.at(this->args.word_column_idx)) {
-                    ++word_amount_found;
-                    // append entire row
-                    if (this->args.verbose) {
-                        std::cout << "OK: found target word '" << *itr
-                                  << "' that is equal to the word at column no. '"
-                                  << this->args.word_column_idx << "', which, based on the index, is equal to '"
-                                  << row.at(this->args.word_column_idx)
-                                  << "' ("
-                                  << word_amount_found << "/" << word_amount_total
-                                  << ").\n";
-                    }
-                    else {
-                        std::cout << "OK: found target word '" << *itr
-                                  << "' ("
-                                  << word_amount_found << "/" << word_amount_total
-                                  << ").\n";
-                    }
-                    // if found, remove from global target word pool (so it doesn't check the same word again)
-                    itr = vec_target_words.erase(itr);
-                    vec_temp.clear();  // otherwise it all keeps piling up
-                    for (const auto &column : row) {
-                        vec_temp.push_back(column);
-                    }
-                    // push entire row, then do not check next word
-                    v.push_back(vec_temp);
-                    break;
-                }
-                else {
-                    ++itr;
-                }
-            }
+        // totals have no original bytes, so "--format raw" writes them as CSV
+        OutputWriter::Writer writer(this->args.filename_output, this->args.output_format);
+        const std::size_t column = this->args.word_column_idx;
+        std::vector<std::string_view> names{column < header.field_count(0) ? header.field(0, column) : std::string_view("word")};
+        std::vector<Schema::type_t> types{Schema::type_t::text};
+        for (std::size_t i = 0; i != totals.size(); ++i) {
+            names.push_back(totals.name(i));
+            types.push_back(Schema::type_t::real);
         }
-        v.shrink_to_fit();
-        if (word_amount_found != word_amount_total) {
-            std::cout << "WARNING: couldn't find matches for the following words:\n";
-            for (std::size_t i = 0; i != vec_target_words.size(); ++i) {
-                std::cout << (i + 1) << ". '" << vec_target_words.at(i) << "'\n";
+        writer.write_header(names, types);
+        std::vector<std::string> values(totals.size());
+        std::vector<std::string_view> row(totals.size() + 1);
+        for (std::size_t word_idx = 0; word_idx != word_amount_total; ++word_idx) {
+            const std::uint64_t rows = totals.rows(word_idx);
+            if (rows == 0) {
+                continue;
             }
-            if (word_amount_found == 0) {
-                std::cerr << "ERROR: output CSV will not be saved, "
-                             "because '0' words were found.\n";
-                return false;
+            matcher.mark_found(word_idx);
+            Logger::ok() << "found target word '" << matcher.word(word_idx)
+                         << "' in '" << rows << "' rows ("
+                         << matcher.found_count() << "/" << word_amount_total
+                         << ").";
+            row[0] = matcher.word(word_idx);
+            for (std::size_t i = 0; i != totals.size(); ++i) {
+                values[i].clear();
+                totals.value(word_idx, i, values[i]);
+                row[i + 1] = values[i];
             }
-            std::cout << "WARNING: output CSV will be saved anyway, despite the '"
-                      << (word_amount_total - word_amount_found)
-                      << "' missing words.\n";
+            writer.write_row(row);
         }
-        return true;
+        Stats::add(Stats::counter_t::matches, rows_total);
+        return this->finish(writer);
     }
 
   public:
@@ -166,67 +201,940 @@ class WordsHelper {
         this->args = args;
     }
 
-    bool csv_to_string(std::string &s)
-    {
-        // if not already processed, extract csv and turn into string
-        if (this->result.empty()) {
-            vec_csv_t vec_csv;
-            std::size_t header_len = 0;
-            if (!this->process_csv(vec_csv, header_len)) {
-                std::cerr << "ERROR: failed to turn a vector into a comma-separated string.\n";
-                return false;
-            }
-            // convert vector into CSV string
-
-            for (std::size_t i = 0; i != vec_csv.size(); ++i) {
-                vec_temp_t v = vec_csv.at(i);  // access item by index
-                vec_temp_t::size_type row_len = v.size();
-                if (row_len != header_len) {
-                    std::cout << "WARNING: skipping entire row at index '"
-                              << i
-                              << "', because its length of '"
-                              << row_len
-                              << "' columns is not equal to header length of '"
-                              << header_len
-                              << "' columns.\n";
+    bool load_words()
+    {
+        /*
+         * Load target words and build the hash table, so every row costs a single lookup
+         * instead of a scan over all target words.
+         *
+         * Return True if succeeded, False if failed.
+         */
+        const Stats::PhaseTimer timer(Stats::phase_t::load_words);
+        DiskManager::LineFile words;
+        if (!load_word_list(words)) {
+            Logger::error() << "failed to extract target words file: '" << this->args.filename_words
+                            << "'.";
+            return false;
+        }
+        // the matcher keeps its own copy of every unique word, so the words file is unmapped right after
+        this->matcher.emplace(words.get_lines(), this->args.normalize, this->args.max_distance);
+        if (this->matcher->duplicate_count() != 0) {
+            Logger::warning() << "ignoring '" << this->matcher->duplicate_count()
+                              << "' duplicate target words in '" << this->args.filename_words << "'.";
+            if (this->args.verbose) {
+                Logger::Line line = Logger::debug();
+                line << "here are all the duplicates:";
+                for (const WordMatcher::Matcher::duplicate_t &duplicate : this->matcher->get_duplicates()) {
+                    line << "\n'" << words.get_lines()[duplicate.position] << "' (target word no. '" << (duplicate.position + 1)
+                         << "'), same as '" << this->matcher->word(duplicate.word) << "'";
+                }
+            }
+        }
+        if (this->args.incremental) {
+            this->settings = Checkpoint::settings_hash(this->args, words.get_lines());
+        }
+        return true;
+    }
+
+    void resume(const std::string_view data, const std::size_t rows_begin)
+    {
+        /*
+         * Limit the rows of an incremental job ("--incremental") to those that were appended since its last run,
+         * and mark the target words that were found back then. Rows begin at "rows_begin" (after the header),
+         * and only rows that end with a newline are processed, so a row that is still being written is left for later.
+         * If the last run can't be resumed, every row is processed and the output is written from scratch.
+         */
+        if (!this->args.incremental) {
+            return;
+        }
+        this->rows_begin = rows_begin;
+        this->rows_end = Checkpoint::complete_rows(data);
+        std::size_t offset;
+        std::vector<std::size_t> found;
+        if (!Checkpoint::resume(this->args, data, this->settings, offset, found)) {
+            return;
+        }
+        for (const std::size_t word_idx : found) {
+            if (word_idx < this->matcher->size()) {
+                this->matcher->mark_found(word_idx);
+            }
+        }
+        this->rows_begin = std::max(rows_begin, offset);
+        this->resumed = true;
+    }
+
+    bool check_header(const CsvReader::RowStore &header, std::vector<Schema::type_t> types)
+    {
+        /*
+         * Check if requested column index is out of CSV's bounds, and resolve the columns used by "--where".
+         * "types" are the inferred column types, which "--schema" may override for this job.
+         *
+         * Return True if it is within bounds, False otherwise.
+         */
+        const std::size_t header_len = header.field_count(0);
+        if (this->args.word_column_idx >= header_len) {
+            Logger::error() << "the target column index '"
+                            << this->args.word_column_idx
+                            << "' is larger than the total amount of columns '"
+                            << header_len
+                            << "'. Please enter a number using '--column' that "
+                               "is smaller than '"
+                            << header_len << "'.";
+            return false;
+        }
+        std::vector<Schema::entry_t> schema;
+        if (!this->args.schema.empty() && !(Schema::parse(this->args.schema, schema) && Schema::apply(schema, header, types))) {
+            return false;
+        }
+        if (!this->args.where.empty() && !(this->where.parse(this->args.where) && this->where.resolve(header, types))) {
+            return false;
+        }
+        if (!this->args.aggregate.empty() && !(this->aggregate.parse(this->args.aggregate) && this->aggregate.resolve(header))) {
+            return false;
+        }
+        this->types = types;
+        return true;
+    }
+
+    bool is_exhaustive() const
+    {
+        /*
+         * Return True if every matching row is needed ("--all-matches" or "--aggregate"), False if only the first one is.
+         */
+        return this->args.all_matches || !this->args.aggregate.empty();
+    }
+
+    bool keeps_raw() const
+    {
+        /*
+         * Return True if rows are saved as they appear in the input ("--format raw"), False if they are written anew.
+         */
+        return this->args.output_format == OutputWriter::format_t::raw && this->args.aggregate.empty();
+    }
+
+    bool saves_rejects() const
+    {
+        /*
+         * Return True if rows with a wrong amount of columns are saved ("--rejects"), False if they are only counted.
+         */
+        return !this->args.filename_rejects.empty();
+    }
+
+    bool can_use_index() const
+    {
+        /*
+         * Return True if the index can answer this job, False otherwise.
+         * The index stores a hash of the exact key of every valid row, so it can't answer normalized or approximate lookups;
+         * here it is only used for the first match of every target word.
+         */
+        return this->matcher->is_exact() && !this->is_exhaustive() && !this->args.incremental;
+    }
+
+    bool is_incremental() const
+    {
+        /*
+         * Return True if only new rows are processed ("--incremental"), False if every row is.
+         */
+        return this->args.incremental;
+    }
+
+    bool is_found_earlier(const std::size_t word_idx) const
+    {
+        /*
+         * Return True if an earlier run found the target word at "word_idx" ("--incremental"), False otherwise.
+         * Only valid before the matches of this run are saved.
+         */
+        return this->resumed && this->matcher->is_found(word_idx);
+    }
+
+    std::size_t first_row() const
+    {
+        /*
+         * Return the offset of the first row this job processes.
+         */
+        return this->rows_begin;
+    }
+
+    Scan::job_t scan_job() const
+    {
+        /*
+         * Return this job as the scan sees it; the caller fills in which target words are already found.
+         */
+        return Scan::job_t{&*this->matcher, &this->where, this->column(), this->is_exhaustive(), this->rows_begin, this->rows_end, {}};
+    }
+
+    std::size_t column() const
+    {
+        return this->args.word_column_idx;
+    }
+
+    const WordMatcher::Matcher &get_matcher() const
+    {
+        return *this->matcher;
+    }
+
+    const Query::Predicate &get_where() const
+    {
+        return this->where;
+    }
+
+    const Aggregate::Table &get_aggregate() const
+    {
+        return this->aggregate;
+    }
+
+    bool save_rejects(const std::vector<rejects_t> &chunk_rejects) const
+    {
+        /*
+         * Save the rows that were skipped because of their amount of columns, if "--rejects" is set.
+         * Every row is saved as its line, its byte offset and its bytes (as a single quoted field).
+         *
+         * Return True if succeeded, False if failed.
+         */
+        if (this->args.filename_rejects.empty()) {
+            return true;
+        }
+        DiskManager::BufferedWriter writer(this->args.filename_rejects);
+        writer.write("line,offset,row\n");
+        std::size_t reject_amount = 0;
+        for (const rejects_t &rejects : chunk_rejects) {
+            for (const reject_t &reject : rejects.rows) {
+                writer.write(std::to_string(reject.line));
+                writer.put(',');
+                writer.write(std::to_string(reject.offset));
+                writer.write(",\"");
+                // double the quotes, so the row reads back as a single field
+                std::string_view bytes = reject.bytes;
+                for (std::size_t quote = bytes.find('"'); quote != std::string_view::npos; quote = bytes.find('"')) {
+                    writer.write(bytes.substr(0, quote + 1));
+                    writer.put('"');
+                    bytes.remove_prefix(quote + 1);
+                }
+                writer.write(bytes);
+                writer.write("\"\n");
+                ++reject_amount;
+            }
+        }
+        const bool result = writer.flush();
+        if (result) {
+            Logger::info() << "saved '" << reject_amount << "' rejected rows to '" << this->args.filename_rejects << "'.";
+        }
+        else {
+            Logger::error() << "failed to save rejected rows to '" << this->args.filename_rejects << "'.";
+        }
+        return result;
+    }
+
+    bool save_state(const std::string_view data) const
+    {
+        /*
+         * Save where this run stopped and which target words were found, so the next run only processes new rows
+         * ("--incremental"). Nothing is saved for other jobs.
+         *
+         * Return True if succeeded, False if failed.
+         */
+        if (!this->args.incremental) {
+            return true;
+        }
+        std::vector<std::size_t> found;
+        for (std::size_t word_idx = 0; word_idx != this->matcher->size(); ++word_idx) {
+            if (this->matcher->is_found(word_idx)) {
+                found.push_back(word_idx);
+            }
+        }
+        return Checkpoint::save(this->args, Checkpoint::make_header(data, this->rows_end, this->settings), found);
+    }
+
+    bool save_matches(const std::string_view data, const CsvReader::RowStore &header, const std::vector<const matches_t *> &chunk_matches)
+    {
+        /*
+         * Merge the matching rows of all chunks and stream them to the output CSV.
+         * Rows go through a fixed-size buffer, so memory use doesn't depend on the amount of matches.
+         * "data" is the entire input, it's only used by "--incremental" and "--format raw" (and empty for compressed input).
+         *
+         * Return True if succeeded, False if failed.
+         */
+        if (!this->aggregate.empty()) {
+            return this->save_totals(header, chunk_matches);
+        }
+        const Stats::PhaseTimer timer(Stats::phase_t::write);
+        WordMatcher::Matcher &matcher = *this->matcher;
+        const std::size_t word_amount_total = matcher.size();  // total amount of unique words
+        struct match_t {
+            std::size_t offset;
+            const CsvReader::RowStore *store;
+            std::size_t row;
+            std::size_t word_idx;
+        };
+        std::vector<match_t> matches;
+        if (this->args.all_matches) {
+            // chunks don't overlap, so every stored row is saved once
+            for (const matches_t *chunk : chunk_matches) {
+                for (std::size_t row = 0; row != chunk->rows.size(); ++row) {
+                    matches.push_back(match_t{chunk->rows.offset(row), &chunk->rows, row, chunk->words[row]});
+                }
+            }
+        }
+        else {
+            // the earliest chunk wins, so the first matching row in the file is kept for each word
+            for (std::size_t word_idx = 0; word_idx != word_amount_total; ++word_idx) {
+                if (this->is_found_earlier(word_idx)) {
+                    continue;
+                }
+                for (const matches_t *chunk : chunk_matches) {
+                    const std::size_t row = chunk->first[word_idx];
+                    if (row != WordMatcher::Matcher::npos) {
+                        matches.push_back(match_t{chunk->rows.offset(row), &chunk->rows, row, word_idx});
+                        break;
+                    }
+                }
+            }
+        }
+        // an incremental run only appends, so finding nothing new is fine
+        if (matches.empty() && !this->resumed) {
+            this->print_missing();
+            Logger::error() << "output CSV will not be saved, "
+                               "because '0' words were found.";
+            return false;
+        }
+        // keep the order of rows in the input
+        std::sort(matches.begin(), matches.end(), [](const match_t &a, const match_t &b) {
+            return a.offset < b.offset;
+        });
+        const std::size_t header_len = header.field_count(0);
+        // an appended output already has its header, but "--format jsonl" still needs the names of the columns
+        OutputWriter::Writer writer(this->args.filename_output, this->args.output_format, this->resumed);
+        writer.write_header(header, this->types, this->original_row(data, header, 0));
+        if (this->resumed && this->args.verbose) {
+            Logger::debug() << "appending '" << matches.size() << "' new rows to '" << this->args.filename_output << "'.";
+        }
+        for (const auto &[row_offset, store, row, word_idx] : matches) {
+            // with "--all-matches", a word is reported once, at its first row
+            const bool first_match = matcher.mark_found(word_idx);
+            if (first_match && this->args.verbose) {
+                Logger::ok() << "found target word '" << matcher.word(word_idx)
+                             << "' that " << (matcher.is_exact() ? "is equal to" : "matches") << " the word at column no. '"
+                             << this->args.word_column_idx << "', which, based on the index, is equal to '"
+                             << store->field(row, this->args.word_column_idx)
+                             << "' ("
+                             << matcher.found_count() << "/" << word_amount_total
+                             << ").";
+            }
+            else if (first_match) {
+                Logger::ok() << "found target word '" << matcher.word(word_idx)
+                             << "' ("
+                             << matcher.found_count() << "/" << word_amount_total
+                             << ").";
+            }
+            if (store->field_count(row) != header_len) {
+                Logger::warning() << "skipping entire row at byte offset '"
+                                  << row_offset
+                                  << "', because its length of '"
+                                  << store->field_count(row)
+                                  << "' columns is not equal to header length of '"
+                                  << header_len
+                                  << "' columns.";
+                continue;
+            }
+            writer.write_row(*store, row, this->original_row(data, *store, row));
+        }
+        Stats::add(Stats::counter_t::matches, matches.size());
+        return this->finish(writer) && this->save_state(data);
+    }
+};
+
+class JobsHelper {
+  private:
+    // types
+    using vec_matches_t = std::vector<matches_t>;  // one per job
+
+    // variables
+    std::string filename_csv;
+    std::size_t threads;
+    bool read_ahead;  // read uncompressed input as a stream instead of mapping it ("--read-ahead")
+    bool verbose;
+    std::vector<WordsHelper> jobs;
+    std::size_t column_count = 0;  // amount of columns in the header, every other row must have as many
+    bool keep_rejects = false;     // True if any job saves invalid rows ("--rejects")
+    bool keep_raw = false;         // True if any job saves rows as they appear in streamed input ("--format raw")
+
+    vec_matches_t new_matches(const std::vector<std::size_t> &scan_jobs, const bool keep_raw = false) const
+    {
+        /*
+         * Return empty matches for every job in "scan_jobs"; with "keep_raw", rows are also stored as they appear in the input.
+         */
+        vec_matches_t chunk_matches(scan_jobs.size());
+        for (std::size_t i = 0; i != scan_jobs.size(); ++i) {
+            const WordsHelper &job = this->jobs[scan_jobs[i]];
+            chunk_matches[i].rows = CsvReader::RowStore(keep_raw && job.keeps_raw());
+            chunk_matches[i].first.assign(job.get_matcher().size(), WordMatcher::Matcher::npos);
+            // words found by an earlier run are skipped like words found by this one, unless every match is needed
+            for (std::size_t word_idx = 0; word_idx != job.get_matcher().size() && !job.is_exhaustive(); ++word_idx) {
+                if (job.is_found_earlier(word_idx)) {
+                    chunk_matches[i].first[word_idx] = found_earlier;
+                }
+            }
+            chunk_matches[i].totals = job.get_aggregate();
+            chunk_matches[i].totals.reset(job.get_matcher().size());
+        }
+        return chunk_matches;
+    }
+
+    std::size_t scan_rows(const std::string_view data,
+                          const std::size_t row_begin,
+                          const std::size_t row_limit,
+                          const std::size_t base_offset,
+                          const std::size_t base_line,
+                          const std::vector<std::size_t> &scan_jobs,
+                          Logger::RateLimiter &row_messages,
+                          vec_matches_t &chunk_matches,
+                          rejects_t &rejects) const
+    {
+        /*
+         * Check all rows that begin in [row_begin, row_limit) against the target words of every job in "scan_jobs",
+         * see "Scan::scan_rows()". Matchers are only read, so several chunks can be scanned at the same time.
+         * Per-row debug messages are capped by "row_messages", which is shared by all chunks.
+         *
+         * The first matching row of each target word is copied to "chunk_matches" (one per job),
+         * words that were already found there are skipped. "base_offset" is the offset of "data" in the input,
+         * and "base_line" is the amount of lines before it.
+         * Rejected rows are counted in "rejects", and kept there if "--rejects" is set; lines are only counted up to them.
+         *
+         * Return the amount of target words that are still missing, which is never 0 if a job needs every row.
+         */
+        std::vector<Scan::job_t> jobs;
+        jobs.reserve(scan_jobs.size());
+        for (std::size_t i = 0; i != scan_jobs.size(); ++i) {
+            jobs.push_back(this->jobs[scan_jobs[i]].scan_job());
+            const std::vector<std::size_t> &first = chunk_matches[i].first;
+            jobs.back().found.resize(first.size());
+            for (std::size_t word_idx = 0; word_idx != first.size(); ++word_idx) {
+                jobs.back().found[word_idx] = (first[word_idx] != WordMatcher::Matcher::npos);
+            }
+        }
+        std::string value_buffer;     // only used for "--aggregate" columns that contain escaped quotes
+        std::size_t line = 1;         // line at "line_offset", only counted when a row is rejected
+        std::size_t line_offset = 0;  // offset in "data" up to which lines were counted
+        const auto on_match = [&](const std::size_t i, const std::size_t word_idx, const bool first_match,
+                                  const std::size_t row_offset, const CsvReader::row_t &row) {
+            matches_t &matches = chunk_matches[i];
+            // totals are updated in place, the row itself is not needed
+            if (!matches.totals.empty()) {
+                matches.totals.add(word_idx, row, value_buffer);
+                return true;
+            }
+            // copied right away, the row's bytes are appended to the job's store (no allocation per row)
+            const std::size_t stored = matches.rows.add(row, base_offset + row_offset);
+            matches.words.push_back(word_idx);
+            if (first_match) {
+                matches.first[word_idx] = stored;
+            }
+            return true;
+        };
+        const auto on_reject = [&](const std::size_t row_offset, const CsvReader::row_t &row) {
+            ++rejects.count;
+            if (this->keep_rejects) {
+                line += static_cast<std::size_t>(std::count(data.begin() + static_cast<std::ptrdiff_t>(line_offset),
+                                                            data.begin() + static_cast<std::ptrdiff_t>(row_offset), '\n'));
+                line_offset = row_offset;
+                rejects.rows.push_back(reject_t{base_offset + row_offset, base_line + line, std::string(row.bytes)});
+            }
+        };
+        return Scan::scan_rows(data, row_begin, row_limit, base_offset, this->column_count, jobs,
+                               this->verbose ? &row_messages : nullptr, on_match, on_reject);
+    }
+
+    bool lookup_cache(const std::string_view data, const WordsHelper &job, matches_t &matches) const
+    {
+        /*
+         * Answer a job from the columnar cache of its column, if there is an up-to-date one (see "--build-cache").
+         * Target words are mapped to distinct keys once, then only the 4-byte key of each row is read;
+         * the CSV is parsed only for rows that match, and numeric columns used by "--aggregate" come from the cache too.
+         *
+         * Return True if the cache was used, False if it is missing or stale (the caller has to use the index or scan instead).
+         */
+        ColumnCache::Cache cache;
+        if (!cache.open(this->filename_csv, data, job.column(), this->verbose)) {
+            return false;
+        }
+        const WordMatcher::Matcher &matcher = job.get_matcher();
+        constexpr std::size_t npos = WordMatcher::Matcher::npos;
+        // exact words are looked up in the dictionary, otherwise every distinct key is normalized (still far fewer than rows)
+        std::vector<std::size_t> key_words(cache.key_count(), npos);
+        if (matcher.is_exact()) {
+            for (std::size_t word_idx = 0; word_idx != matcher.size(); ++word_idx) {
+                const std::size_t key_idx = cache.find(matcher.word(word_idx));
+                if (key_idx != ColumnCache::Cache::npos) {
+                    key_words[key_idx] = word_idx;
+                }
+            }
+        }
+        else {
+            WordMatcher::Matcher::buffer_t match_buffer;
+            for (std::size_t key_idx = 0; key_idx != cache.key_count(); ++key_idx) {
+                key_words[key_idx] = matcher.find(cache.key(key_idx), match_buffer);
+            }
+        }
+        matches.first.assign(matcher.size(), npos);
+        matches.totals = job.get_aggregate();
+        matches.totals.reset(matcher.size());
+        CsvReader::row_t row;
+        // the dictionary knows the first row of every key, so without a filter, no row keys are read at all
+        if (!job.is_exhaustive() && job.get_where().empty()) {
+            std::vector<std::size_t> first_rows(matcher.size(), npos);
+            for (std::size_t key_idx = 0; key_idx != cache.key_count(); ++key_idx) {
+                const std::size_t word_idx = key_words[key_idx];
+                if (word_idx != npos) {
+                    first_rows[word_idx] = std::min(first_rows[word_idx], cache.first_row(key_idx));
+                }
+            }
+            bool all_valid = true;
+            for (std::size_t word_idx = 0; word_idx != matcher.size() && all_valid; ++word_idx) {
+                if (first_rows[word_idx] != npos) {
+                    CsvReader::Reader row_reader(data, cache.offset(first_rows[word_idx]));
+                    row_reader.next_row(row);
+                    all_valid = row.fields.size() == this->column_count;
+                    matches.first[word_idx] = matches.rows.add(row, cache.offset(first_rows[word_idx]));
+                    matches.words.push_back(word_idx);
+                }
+            }
+            if (all_valid) {
+                return true;
+            }
+            // invalid rows are never the first row of a key, but if one is, the row keys below skip it like the scan does
+            matches.first.assign(matcher.size(), npos);
+            matches.rows.clear();
+            matches.words.clear();
+        }
+        std::string where_buffer;
+        std::string value_buffer;
+        std::size_t words_left = matcher.size();
+        for (std::size_t row_idx = 0; row_idx != cache.rows() && (words_left != 0 || job.is_exhaustive()); ++row_idx) {
+            const std::uint32_t key_idx = cache.row_key(row_idx);
+            const std::size_t word_idx = (key_idx == ColumnCache::Cache::no_key) ? npos : key_words[key_idx];
+            if (word_idx == npos) {
+                continue;
+            }
+            const bool first_match = (matches.first[word_idx] == npos);
+            if (!first_match && !job.is_exhaustive()) {
+                continue;
+            }
+            // a row is parsed at most once, and only if something needs its text
+            bool parsed = false;
+            const auto parse_row = [&]() {
+                if (!parsed) {
+                    CsvReader::Reader row_reader(data, cache.offset(row_idx));
+                    row_reader.next_row(row);
+                    parsed = true;
+                }
+            };
+            if (!job.get_where().empty()) {
+                parse_row();
+                if (!job.get_where().matches(row, where_buffer)) {
                     continue;
                 }
-                for (vec_temp_t::size_type i = 0; i < header_len; ++i) {
-                    this->result += v.at(i);
-                    // add comma unless last item
-                    if ((i + 1) < header_len) {
-                        this->result += ',';
+            }
+            if (!matches.totals.empty()) {
+                matches.totals.add_row(word_idx);
+                for (std::size_t i = 0; i != matches.totals.size(); ++i) {
+                    const std::size_t column = matches.totals.source(i);
+                    double number;
+                    if (column == std::string::npos) {
+                        continue;
+                    }
+                    if (cache.is_numeric(column)) {
+                        if (cache.number(row_idx, column, number)) {
+                            matches.totals.add_number(word_idx, i, number);
+                        }
+                        continue;
+                    }
+                    parse_row();
+                    if (column < row.fields.size()) {
+                        matches.totals.add_value(word_idx, i, CsvReader::field_value(row.fields[column], value_buffer));
                     }
                 }
-                this->result += '\n';
+                continue;
+            }
+            parse_row();
+            if (row.fields.size() != this->column_count) {
+                continue;
+            }
+            const std::size_t stored = matches.rows.add(row, cache.offset(row_idx));
+            matches.words.push_back(word_idx);
+            if (first_match) {
+                matches.first[word_idx] = stored;
+                --words_left;
             }
         }
-        s = this->result;
         return true;
     }
+
+    bool check_jobs(const CsvReader::RowStore &header, const std::vector<Schema::type_t> &types)
+    {
+        /*
+         * Drop jobs whose column is out of the CSV's bounds, but keep the rest.
+         *
+         * Return True if all jobs are valid, False if any of them were dropped.
+         */
+        this->column_count = header.field_count(0);
+        if (this->verbose) {
+            Logger::Line line = Logger::debug();
+            line << "header has '" << header.field_count(0) << "' columns:";
+            for (std::size_t i = 0; i != header.field_count(0); ++i) {
+                line << "\nHeader column no. " << i << " = '" << header.field(0, i) << "' (" << Schema::type_name(types[i]) << ")";
+            }
+        }
+        bool success = true;
+        std::erase_if(this->jobs, [&](WordsHelper &job) {
+            const bool valid = job.check_header(header, types);
+            success = success && valid;
+            return !valid;
+        });
+        return success;
+    }
+
+    bool save_all(const std::string_view data,
+                  const CsvReader::RowStore &header,
+                  const std::vector<std::size_t> &scan_jobs,
+                  const std::vector<vec_matches_t> &chunk_matches,
+                  const vec_matches_t &index_matches,
+                  const std::vector<rejects_t> &chunk_rejects)
+    {
+        /*
+         * Save the matches of every job, which come either from the chunks of the scan or from its index.
+         * Rows that were rejected by the scan are reported once, and saved by every job that asks for them.
+         *
+         * Return True if all jobs succeeded, False if any of them failed.
+         */
+        std::uint64_t reject_amount = 0;
+        for (const rejects_t &rejects : chunk_rejects) {
+            reject_amount += rejects.count;
+        }
+        if (reject_amount != 0) {
+            Logger::warning() << "skipped '" << reject_amount << "' rows, because their amount of columns is not equal to header length of '"
+                              << this->column_count << "' columns.";
+        }
+        bool success = true;
+        std::size_t scan_idx = 0;
+        for (std::size_t job_idx = 0; job_idx != this->jobs.size(); ++job_idx) {
+            std::vector<const matches_t *> job_matches;
+            if (scan_idx != scan_jobs.size() && scan_jobs[scan_idx] == job_idx) {
+                for (const auto &matches : chunk_matches) {
+                    job_matches.push_back(&matches[scan_idx]);
+                }
+                ++scan_idx;
+            }
+            else {
+                job_matches.push_back(&index_matches[job_idx]);
+            }
+            if (!this->jobs[job_idx].save_matches(data, header, job_matches)) {
+                success = false;
+            }
+            if (!this->jobs[job_idx].save_rejects(chunk_rejects)) {
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    bool process_mapped()
+    {
+        /*
+         * Map an uncompressed CSV into memory, so it can be split into chunks and scanned in parallel.
+         *
+         * Return True if all jobs succeeded, False if any of them failed.
+         */
+        // map CSV into memory, rows and fields are views into the mapping
+        const CsvReader::MappedFile file(this->filename_csv);
+        if (!file.is_open()) {
+            return false;
+        }
+        CsvReader::Reader reader(file.data());
+        CsvReader::row_t header_row;
+        // read header separately to prevent bool checks for the following rows
+        reader.next_row(header_row);
+        CsvReader::RowStore header;
+        header.add(header_row, 0);
+        // column types are guessed from the rows right after the header
+        bool success = this->check_jobs(header, Schema::infer(file.data(), reader.offset(), header.field_count(0)));
+        if (this->jobs.empty()) {
+            return false;
+        }
+        for (WordsHelper &job : this->jobs) {
+            job.resume(file.data(), reader.offset());
+        }
+        // jobs with an up-to-date cache or index skip the scan entirely
+        vec_matches_t index_matches(this->jobs.size());
+        std::vector<std::size_t> scan_jobs;
+        std::optional<Stats::PhaseTimer> index_timer(std::in_place, Stats::phase_t::index_lookup);
+        for (std::size_t job_idx = 0; job_idx != this->jobs.size(); ++job_idx) {
+            const WordsHelper &job = this->jobs[job_idx];
+            // a cache knows every row, not only the new ones
+            if (!job.is_incremental() && this->lookup_cache(file.data(), job, index_matches[job_idx])) {
+                continue;
+            }
+            std::vector<std::size_t> &first = index_matches[job_idx].first;
+            // the index only has hashes of exact keys, so it can't answer normalized or approximate lookups,
+            // and jobs that need every matching row (or only new rows) are left to the scan
+            if (!job.can_use_index()) {
+                if (this->verbose) {
+                    Logger::debug() << "not using the index of column no. '" << job.column()
+                                    << "', because '--normalize', '--max-distance', '--all-matches', '--aggregate' or '--incremental' is set.";
+                }
+                scan_jobs.push_back(job_idx);
+                continue;
+            }
+            if (!ColumnIndex::lookup(this->filename_csv, file.data(), job.column(), job.get_matcher(), job.get_where(), first, this->verbose)) {
+                scan_jobs.push_back(job_idx);
+                continue;
+            }
+            // the index only knows offsets, so copy those rows into the store like the scan does
+            CsvReader::row_t row;
+            for (std::size_t &entry : first) {
+                if (entry != WordMatcher::Matcher::npos) {
+                    CsvReader::Reader row_reader(file.data(), entry);
+                    row_reader.next_row(row);
+                    entry = index_matches[job_idx].rows.add(row, entry);
+                }
+            }
+        }
+        index_timer.reset();
+        std::vector<vec_matches_t> chunk_matches;
+        std::vector<rejects_t> chunk_rejects;
+        if (!scan_jobs.empty()) {
+            // split rows into chunks, one per thread; with a single thread, this is the entire file
+            std::optional<Stats::PhaseTimer> split_timer(std::in_place, Stats::phase_t::split);
+            // if every job is incremental, rows that all of them processed before aren't read at all
+            std::size_t scan_begin = file.data().size();
+            for (const std::size_t job_idx : scan_jobs) {
+                scan_begin = std::min(scan_begin, std::max(reader.offset(), this->jobs[job_idx].first_row()));
+            }
+            const std::vector<std::size_t> bounds = CsvReader::split_rows(file.data(), scan_begin, this->threads);
+            split_timer.reset();
+            const Stats::PhaseTimer scan_timer(Stats::phase_t::scan);
+            Logger::RateLimiter row_messages(1000);
+            const std::size_t chunk_amount = bounds.size() - 1;
+            chunk_matches.assign(chunk_amount, this->new_matches(scan_jobs));
+            chunk_rejects.resize(chunk_amount);
+            if (chunk_amount == 1) {
+                this->scan_rows(file.data(), bounds[0], bounds[1], 0, 0, scan_jobs, row_messages, chunk_matches[0], chunk_rejects[0]);
+            }
+            else {
+                if (this->verbose) {
+                    Logger::debug() << "scanning '" << chunk_amount << "' chunks in parallel.";
+                }
+                std::vector<std::thread> workers;
+                workers.reserve(chunk_amount);
+                for (std::size_t k = 0; k != chunk_amount; ++k) {
+                    workers.emplace_back([&, k]() {
+                        this->scan_rows(file.data(), bounds[k], bounds[k + 1], 0, 0, scan_jobs, row_messages, chunk_matches[k], chunk_rejects[k]);
+                    });
+                }
+                for (auto &worker : workers) {
+                    worker.join();
+                }
+            }
+            if (row_messages.suppressed() != 0) {
+                Logger::debug() << "suppressed '" << row_messages.suppressed() << "' per-row messages.";
+            }
+        }
+        return this->save_all(file.data(), header, scan_jobs, chunk_matches, index_matches, chunk_rejects) && success;
+    }
+
+    bool process_stream(const InputStream::format_t format)
+    {
+        /*
+         * Read (and decompress) a CSV on separate threads and scan the blocks as they arrive.
+         * Nothing is unpacked to disk, and only a few buffers are held in memory at once.
+         *
+         * Return True if all jobs succeeded, False if any of them failed.
+         */
+        if (this->verbose) {
+            Logger::debug() << "reading " << InputStream::format_name(format) << (format == InputStream::format_t::plain ? "" : "-compressed")
+                            << " CSV '" << this->filename_csv << "' as a stream.";
+        }
+        if (this->verbose && this->threads > 1) {
+            Logger::debug() << "'--threads' is ignored for streamed input, which is scanned on a single thread.";
+        }
+        InputStream::RowStream stream(this->filename_csv);
+        std::string_view rows;
+        std::size_t base_offset = 0;
+        // header comes first; if the input is empty, there is no header (like an empty uncompressed CSV)
+        // decompressed blocks are reused, so rows that are saved as they are must be copied ("--format raw")
+        CsvReader::RowStore header(this->keep_raw);
+        std::size_t row_begin = 0;
+        CsvReader::row_t header_row;
+        if (stream.next(rows, base_offset)) {
+            CsvReader::Reader reader(rows);
+            reader.next_row(header_row);
+            row_begin = reader.offset();
+        }
+        header.add(header_row, 0);
+        // column types are guessed from the rows right after the header, which are in the first block
+        bool success = this->check_jobs(header, Schema::infer(rows, row_begin, header.field_count(0)));
+        if (this->jobs.empty()) {
+            return false;
+        }
+        // streamed files can't be indexed, so every job is scanned
+        std::vector<std::size_t> scan_jobs(this->jobs.size());
+        for (std::size_t job_idx = 0; job_idx != this->jobs.size(); ++job_idx) {
+            scan_jobs[job_idx] = job_idx;
+        }
+        std::vector<vec_matches_t> chunk_matches(1, this->new_matches(scan_jobs, this->keep_raw));
+        std::vector<rejects_t> chunk_rejects(1);
+        {
+            const Stats::PhaseTimer scan_timer(Stats::phase_t::scan);
+            Logger::RateLimiter row_messages(1000);
+            std::size_t words_left = 1;  // at least one, so the first block is always scanned
+            std::size_t base_line = 0;   // lines before the current block, only counted if rejected rows are saved
+            while (words_left != 0 && !rows.empty()) {
+                words_left = this->scan_rows(rows, row_begin, rows.size(), base_offset, base_line, scan_jobs, row_messages, chunk_matches[0], chunk_rejects[0]);
+                if (this->keep_rejects) {
+                    base_line += static_cast<std::size_t>(std::count(rows.begin(), rows.end(), '\n'));
+                }
+                row_begin = 0;
+                if (!stream.next(rows, base_offset)) {
+                    break;
+                }
+            }
+            if (row_messages.suppressed() != 0) {
+                Logger::debug() << "suppressed '" << row_messages.suppressed() << "' per-row messages.";
+            }
+        }
+        if (stream.failed()) {
+            Logger::error() << "output CSV will not be saved, because '" << this->filename_csv << "' could not be "
+                            << (format == InputStream::format_t::plain ? "read." : "decompressed.");
+            return false;
+        }
+        return this->save_all(std::string_view(), header, scan_jobs, chunk_matches, vec_matches_t(), chunk_rejects) && success;
+    }
+
+  public:
+    JobsHelper(const std::string &filename_csv, const std::size_t threads, const bool read_ahead, const bool verbose)
+    /*
+     * Class constructor.
+     */
+    {
+        this->filename_csv = filename_csv;
+        this->threads = threads;
+        this->read_ahead = read_ahead;
+        this->verbose = verbose;
+    }
+
+    void add_job(const ConsoleInput::console_args_t &args)
+    {
+        this->jobs.emplace_back(args);
+    }
+
+    bool process()
+    {
+        /*
+         * Scan the CSV once and save the matching rows of every job to its own output CSV.
+         *
+         * Return True if all jobs succeeded, False if any of them failed.
+         */
+        bool success = true;
+        // drop jobs whose words couldn't be loaded, but still run the rest
+        std::erase_if(this->jobs, [&](WordsHelper &job) {
+            const bool loaded = job.load_words();
+            success = success && loaded;
+            return !loaded;
+        });
+        if (this->jobs.empty()) {
+            return false;
+        }
+        this->keep_rejects = std::any_of(this->jobs.begin(), this->jobs.end(), [](const WordsHelper &job) {
+            return job.saves_rejects();
+        });
+        this->keep_raw = std::any_of(this->jobs.begin(), this->jobs.end(), [](const WordsHelper &job) {
+            return job.keeps_raw();
+        });
+        if (this->verbose) {
+            Logger::debug() << "using '" << StructuralScanner::kernel_name()
+                            << "' kernel to scan for delimiters and newlines.";
+        }
+        const InputStream::format_t format = InputStream::detect_format(this->filename_csv);
+        if (format != InputStream::format_t::plain) {
+            return this->process_stream(format) && success;
+        }
+        if (this->read_ahead) {
+            // only the mapping knows where the rows of the last run ended
+            const bool incremental = std::any_of(this->jobs.begin(), this->jobs.end(), [](const WordsHelper &job) {
+                return job.is_incremental();
+            });
+            if (!incremental) {
+                return this->process_stream(format) && success;
+            }
+            if (this->verbose) {
+                Logger::debug() << "'--read-ahead' is ignored for '" << this->filename_csv << "', because '--incremental' is set.";
+            }
+        }
+        return this->process_mapped() && success;
+    }
 };
 
 namespace ProcessCSV {
 
 bool find_and_save(const ConsoleInput::console_args_t &args)
 {
-    WordsHelper words_helper(args);
-    std::string str_to_save;
-    if (!words_helper.csv_to_string(str_to_save)) {
-        std::cerr << "ERROR: failed to extract the final string that "
-                  << "would be saved to '" << args.filename_output << "'.\n";
-        return false;
-    }
-    if (args.verbose) {
-        std::cout << "RESULT: the following string (" << str_to_save.length()
-                  << " characters) will be saved to '" << args.filename_output << "':\n"
-                  << str_to_save;  // it includes trailing comma
-    }
-    const bool final_result = DiskManager::save_csv_to_disk(args, str_to_save);
-    if (args.verbose) {
-        std::cout << "INFO: save to disk status: " << (final_result ? "success" : "failure") << ".\n";
-    }
-    return true;
+    /*
+     * Run every job from the jobs file (or the single job described by "args" if there is none).
+     * Jobs that read the same CSV share a single pass over it.
+     *
+     * Return True if all jobs succeeded, False if any of them failed.
+     */
+    const std::vector<ConsoleInput::console_args_t> jobs = args.jobs.empty()
+                                                               ? std::vector<ConsoleInput::console_args_t>{args}
+                                                               : args.jobs;
+    // group jobs by input CSV, keeping the order in which each CSV first appears
+    std::vector<JobsHelper> groups;
+    std::vector<std::filesystem::path> group_paths;
+    for (const auto &job : jobs) {
+        const std::filesystem::path path = std::filesystem::weakly_canonical(job.filename_csv);
+        const auto itr = std::find(group_paths.begin(), group_paths.end(), path);
+        if (itr == group_paths.end()) {
+            group_paths.push_back(path);
+            groups.emplace_back(job.filename_csv, args.threads, args.read_ahead, args.verbose);
+            groups.back().add_job(job);
+        }
+        else {
+            groups[static_cast<std::size_t>(itr - group_paths.begin())].add_job(job);
+        }
+    }
+    if (args.verbose && !args.jobs.empty()) {
+        Logger::debug() << "running '" << jobs.size() << "' jobs over '"
+                        << groups.size() << "' distinct CSV files.";
+    }
+    bool success = true;
+    for (auto &group : groups) {
+        if (!group.process()) {
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool build(const ConsoleInput::console_args_t &args)
+{
+    /*
+     * Build a sidecar index ("--build-index") and/or cache ("--build-cache") for the target column
+     * of every job (or of the single job described by "args").
+     *
+     * Return True if all of them were built, False if any of them failed.
+     */
+    const std::vector<ConsoleInput::console_args_t> jobs = args.jobs.empty()
+                                                               ? std::vector<ConsoleInput::console_args_t>{args}
+                                                               : args.jobs;
+    bool success = true;
+    for (const auto &job : jobs) {
+        if (args.build_index && !ColumnIndex::build(job.filename_csv, job.word_column_idx, args.threads, args.verbose)) {
+            success = false;
+        }
+        if (args.build_cache && !ColumnCache::build(job.filename_csv, job.word_column_idx, args.verbose)) {
+            success = false;
+        }
+    }
+    return success;
 }
 
 }  // namespace ProcessCSV
@@ -8,5 +8,6 @@ namespace ProcessCSV {
 
 // prototypes
 bool find_and_save(const ConsoleInput::console_args_t &args);
+bool build(const ConsoleInput::console_args_t &args);
 
 }  // namespace ProcessCSV
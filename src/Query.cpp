@@ -0,0 +1,455 @@
+#include "Query.hpp"
+#include "Logger.hpp"
+#include "Schema.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+class QueryParser {
+  private:
+    // types
+    enum class token_kind_t {
+        end,
+        open,           // (
+        close,          // )
+        comma,          // ,
+        equal,          // =
+        not_equal,      // !=
+        less,           // <
+        less_equal,     // <=
+        greater,        // >
+        greater_equal,  // >=
+        word,           // bare word: keyword, column name or value
+        string,         // 'single-quoted value'
+        column_name,    // "double-quoted column name"
+    };
+
+    struct token_t {
+        token_kind_t kind;
+        std::string text;
+        std::size_t position;
+    };
+
+    // variables
+    const std::string &text;
+    std::vector<token_t> tokens;
+    std::size_t pos = 0;
+    std::vector<Query::node_t> &nodes;
+    std::string error;
+
+    bool tokenize()
+    {
+        /*
+         * Split the expression into tokens.
+         *
+         * Return True if succeeded, False if a quote is not closed or a character is not allowed.
+         */
+        std::size_t i = 0;
+        while (i < this->text.size()) {
+            const char c = this->text[i];
+            const std::size_t start = i;
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                ++i;
+            }
+            else if (c == '(' || c == ')' || c == ',' || c == '=') {
+                const token_kind_t kind = (c == '(')   ? token_kind_t::open
+                                          : (c == ')') ? token_kind_t::close
+                                          : (c == ',') ? token_kind_t::comma
+                                                       : token_kind_t::equal;
+                this->tokens.push_back(token_t{kind, std::string(1, c), start});
+                ++i;
+            }
+            else if (c == '!' && i + 1 < this->text.size() && this->text[i + 1] == '=') {
+                this->tokens.push_back(token_t{token_kind_t::not_equal, "!=", start});
+                i += 2;
+            }
+            else if (c == '<' || c == '>') {
+                const bool or_equal = (i + 1 < this->text.size() && this->text[i + 1] == '=');
+                const token_kind_t kind = (c == '<') ? (or_equal ? token_kind_t::less_equal : token_kind_t::less)
+                                                     : (or_equal ? token_kind_t::greater_equal : token_kind_t::greater);
+                this->tokens.push_back(token_t{kind, this->text.substr(i, or_equal ? 2 : 1), start});
+                i += or_equal ? 2 : 1;
+            }
+            else if (c == '\'' || c == '"') {
+                // quotes inside are escaped by doubling them, like in CSV
+                std::string value;
+                ++i;
+                while (true) {
+                    if (i >= this->text.size()) {
+                        this->fail("a closing quote", start);
+                        return false;
+                    }
+                    if (this->text[i] == c) {
+                        if (i + 1 < this->text.size() && this->text[i + 1] == c) {
+                            value += c;
+                            i += 2;
+                            continue;
+                        }
+                        ++i;
+                        break;
+                    }
+                    value += this->text[i++];
+                }
+                this->tokens.push_back(token_t{c == '\'' ? token_kind_t::string : token_kind_t::column_name, value, start});
+            }
+            else if (c == '!') {
+                this->fail("'!='", start);
+                return false;
+            }
+            else {
+                while (i < this->text.size() && !std::isspace(static_cast<unsigned char>(this->text[i])) &&
+                       std::string_view("()=,!<>'\"").find(this->text[i]) == std::string_view::npos) {
+                    ++i;
+                }
+                this->tokens.push_back(token_t{token_kind_t::word, this->text.substr(start, i - start), start});
+            }
+        }
+        this->tokens.push_back(token_t{token_kind_t::end, "", this->text.size()});
+        return true;
+    }
+
+    const token_t &peek() const
+    {
+        return this->tokens[this->pos];
+    }
+
+    bool is_keyword(const char *keyword) const
+    {
+        /*
+         * Return True if the next token is "keyword" (case-insensitive), False otherwise.
+         */
+        const token_t &token = this->peek();
+        if (token.kind != token_kind_t::word) {
+            return false;
+        }
+        return std::equal(token.text.begin(), token.text.end(), keyword, keyword + std::char_traits<char>::length(keyword),
+                          [](const char a, const char b) { return std::toupper(static_cast<unsigned char>(a)) == b; });
+    }
+
+    void fail(const std::string &expected, const std::size_t position)
+    {
+        if (this->error.empty()) {
+            this->error = "expected " + expected + " at position " + std::to_string(position + 1);
+        }
+    }
+
+    std::size_t add_node(Query::node_t &&node)
+    {
+        this->nodes.push_back(std::move(node));
+        return this->nodes.size() - 1;
+    }
+
+    std::size_t add_group(const Query::op_t op, std::vector<std::size_t> &&children)
+    {
+        /*
+         * Add an "AND" or "OR" node, unless there is a single child, which is used as-is.
+         */
+        if (children.size() == 1) {
+            return children[0];
+        }
+        Query::node_t node{op, "", 0, {}, std::move(children), {}, false};
+        return this->add_node(std::move(node));
+    }
+
+    bool parse_value(std::string &value)
+    {
+        const token_t &token = this->peek();
+        if (token.kind != token_kind_t::string && token.kind != token_kind_t::word) {
+            this->fail("a value (e.g., 'noun')", token.position);
+            return false;
+        }
+        value = token.text;
+        ++this->pos;
+        return true;
+    }
+
+    bool parse_comparison(std::size_t &idx)
+    {
+        const token_t &column = this->peek();
+        if (column.kind != token_kind_t::word && column.kind != token_kind_t::column_name) {
+            this->fail("a column (e.g., PoS, \"Part of speech\" or #3)", column.position);
+            return false;
+        }
+        Query::node_t node{Query::op_t::equal, column.text, 0, {}, {}, {}, false};
+        ++this->pos;
+        const token_t &op = this->peek();
+        if (op.kind == token_kind_t::equal || op.kind == token_kind_t::not_equal) {
+            node.op = (op.kind == token_kind_t::equal) ? Query::op_t::equal : Query::op_t::not_equal;
+            ++this->pos;
+            std::string value;
+            if (!this->parse_value(value)) {
+                return false;
+            }
+            node.values.push_back(value);
+        }
+        else if (op.kind == token_kind_t::less || op.kind == token_kind_t::less_equal ||
+                 op.kind == token_kind_t::greater || op.kind == token_kind_t::greater_equal) {
+            node.op = (op.kind == token_kind_t::less)         ? Query::op_t::less
+                      : (op.kind == token_kind_t::less_equal) ? Query::op_t::less_equal
+                      : (op.kind == token_kind_t::greater)    ? Query::op_t::greater
+                                                              : Query::op_t::greater_equal;
+            const std::string op_text = op.text;
+            ++this->pos;
+            const std::size_t value_position = this->peek().position;
+            std::string value;
+            double number;
+            if (!this->parse_value(value)) {
+                return false;
+            }
+            if (!Schema::parse_real(value, number)) {
+                this->fail("a number after '" + op_text + "'", value_position);
+                return false;
+            }
+            node.values.push_back(value);
+            node.numbers.push_back(number);
+            node.numeric = true;
+        }
+        else if (this->is_keyword("IN")) {
+            node.op = Query::op_t::in;
+            ++this->pos;
+            if (this->peek().kind != token_kind_t::open) {
+                this->fail("'(' after IN", this->peek().position);
+                return false;
+            }
+            do {
+                ++this->pos;
+                std::string value;
+                if (!this->parse_value(value)) {
+                    return false;
+                }
+                node.values.push_back(value);
+            } while (this->peek().kind == token_kind_t::comma);
+            if (this->peek().kind != token_kind_t::close) {
+                this->fail("')' or ','", this->peek().position);
+                return false;
+            }
+            ++this->pos;
+        }
+        else {
+            this->fail("'=', '!=', '<', '<=', '>', '>=' or IN", op.position);
+            return false;
+        }
+        idx = this->add_node(std::move(node));
+        return true;
+    }
+
+    bool parse_primary(std::size_t &idx)
+    {
+        if (this->peek().kind == token_kind_t::open) {
+            ++this->pos;
+            if (!this->parse_or(idx)) {
+                return false;
+            }
+            if (this->peek().kind != token_kind_t::close) {
+                this->fail("')'", this->peek().position);
+                return false;
+            }
+            ++this->pos;
+            return true;
+        }
+        return this->parse_comparison(idx);
+    }
+
+    bool parse_not(std::size_t &idx)
+    {
+        if (!this->is_keyword("NOT")) {
+            return this->parse_primary(idx);
+        }
+        ++this->pos;
+        std::size_t child;
+        if (!this->parse_not(child)) {
+            return false;
+        }
+        idx = this->add_node(Query::node_t{Query::op_t::negate, "", 0, {}, {child}, {}, false});
+        return true;
+    }
+
+    bool parse_and(std::size_t &idx)
+    {
+        std::vector<std::size_t> children(1);
+        if (!this->parse_not(children[0])) {
+            return false;
+        }
+        while (this->is_keyword("AND")) {
+            ++this->pos;
+            children.emplace_back();
+            if (!this->parse_not(children.back())) {
+                return false;
+            }
+        }
+        idx = this->add_group(Query::op_t::all, std::move(children));
+        return true;
+    }
+
+    bool parse_or(std::size_t &idx)
+    {
+        std::vector<std::size_t> children(1);
+        if (!this->parse_and(children[0])) {
+            return false;
+        }
+        while (this->is_keyword("OR")) {
+            ++this->pos;
+            children.emplace_back();
+            if (!this->parse_and(children.back())) {
+                return false;
+            }
+        }
+        idx = this->add_group(Query::op_t::any, std::move(children));
+        return true;
+    }
+
+  public:
+    QueryParser(const std::string &text, std::vector<Query::node_t> &nodes)
+    /*
+     * Class constructor.
+     */
+        : text(text), nodes(nodes)
+    {
+    }
+
+    bool parse()
+    {
+        /*
+         * Compile the expression into "nodes", children first, so the root ends up last.
+         *
+         * Return True if succeeded, False if failed (the reason is printed).
+         */
+        std::size_t root;
+        if (this->tokenize() && this->parse_or(root) && this->peek().kind != token_kind_t::end) {
+            this->fail("AND, OR or the end of the expression", this->peek().position);
+        }
+        if (!this->error.empty()) {
+            Logger::error() << "invalid '--where' expression '" << this->text << "': " << this->error << ".";
+            return false;
+        }
+        return true;
+    }
+};
+
+namespace Query {
+
+bool Predicate::parse(const std::string &text)
+/*
+ * Compile a filter expression, e.g.:
+ * PoS = 'noun' AND (Lang IN ('en', 'pl') OR NOT #4 = '') AND Zipf > 3
+ *
+ * Columns are header names (double-quoted if they contain spaces or symbols) or "#" followed by an index.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    this->nodes.clear();
+    this->text = text;
+    return QueryParser(this->text, this->nodes).parse();
+}
+
+bool Predicate::resolve(const CsvReader::RowStore &header, const std::vector<Schema::type_t> &types)
+/*
+ * Replace column names with indices, so rows are never searched by name.
+ * Values compared against numeric columns are converted to numbers once, so "Freq = 3" also matches "3.0".
+ *
+ * Return True if succeeded, False if a column doesn't exist.
+ */
+{
+    for (node_t &node : this->nodes) {
+        if (node.column_name.empty()) {
+            continue;
+        }
+        if (!find_column(header, node.column_name, node.column)) {
+            Logger::error() << "column '" << node.column_name << "' used in '--where' doesn't exist in the header.";
+            return false;
+        }
+        if (node.numeric || node.column >= types.size() || types[node.column] == Schema::type_t::text) {
+            continue;
+        }
+        node.numbers.resize(node.values.size());
+        node.numeric = true;
+        for (std::size_t i = 0; i != node.values.size(); ++i) {
+            node.numeric = node.numeric && Schema::parse_real(node.values[i], node.numbers[i]);
+        }
+    }
+    return true;
+}
+
+bool Predicate::matches(const CsvReader::row_t &row, std::string &buffer) const
+/*
+ * Return True if "row" passes the filter (or if there is no filter), False otherwise.
+ * Only the columns that are needed to decide are looked at, e.g., "a AND b" stops at a false "a".
+ */
+{
+    return this->nodes.empty() || this->evaluate(this->nodes.size() - 1, row, buffer);
+}
+
+bool Predicate::empty() const
+{
+    return this->nodes.empty();
+}
+
+bool Predicate::evaluate(const std::size_t idx, const CsvReader::row_t &row, std::string &buffer) const
+{
+    const node_t &node = this->nodes[idx];
+    switch (node.op) {
+    case op_t::all:
+        return std::all_of(node.children.begin(), node.children.end(), [&](const std::size_t child) { return this->evaluate(child, row, buffer); });
+    case op_t::any:
+        return std::any_of(node.children.begin(), node.children.end(), [&](const std::size_t child) { return this->evaluate(child, row, buffer); });
+    case op_t::negate:
+        return !this->evaluate(node.children[0], row, buffer);
+    default:
+        break;
+    }
+    // rows that are too short don't have the column, so no comparison can be true
+    if (node.column >= row.fields.size()) {
+        return false;
+    }
+    const std::string_view value = CsvReader::field_value(row.fields[node.column], buffer);
+    // fields that are not numbers (e.g., empty ones) are compared as text, and are never less or greater than a number
+    double number = 0;
+    const bool is_number = node.numeric && Schema::parse_real(value, number);
+    switch (node.op) {
+    case op_t::equal:
+        return is_number ? number == node.numbers[0] : value == node.values[0];
+    case op_t::not_equal:
+        return is_number ? number != node.numbers[0] : value != node.values[0];
+    case op_t::in:
+        return is_number ? std::find(node.numbers.begin(), node.numbers.end(), number) != node.numbers.end()
+                         : std::find(node.values.begin(), node.values.end(), value) != node.values.end();
+    case op_t::less:
+        return is_number && number < node.numbers[0];
+    case op_t::less_equal:
+        return is_number && number <= node.numbers[0];
+    case op_t::greater:
+        return is_number && number > node.numbers[0];
+    case op_t::greater_equal:
+        return is_number && number >= node.numbers[0];
+    default:
+        break;
+    }
+    return false;
+}
+
+bool find_column(const CsvReader::RowStore &header, const std::string &name, std::size_t &column)
+/*
+ * Find a column by its header name, or by "#" followed by its index (e.g., "#3").
+ *
+ * Return True if found, False if the header doesn't have such a column.
+ */
+{
+    const std::size_t header_len = header.field_count(0);
+    if (name.size() > 1 && name[0] == '#' &&
+        std::all_of(name.begin() + 1, name.end(), [](const char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+        // an index too large for "std::size_t" can't be a column either
+        const char *end = name.data() + name.size();
+        const auto [ptr, ec] = std::from_chars(name.data() + 1, end, column);
+        return ec == std::errc() && ptr == end && column < header_len;
+    }
+    for (std::size_t i = 0; i != header_len; ++i) {
+        if (header.field(0, i) == name) {
+            column = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace Query
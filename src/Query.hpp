@@ -0,0 +1,54 @@
+#pragma once
+
+// libraries
+#include "CsvReader.hpp"
+#include "Schema.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// custom namespace
+namespace Query {
+
+// types
+enum class op_t {
+    all,            // every child is true ("AND")
+    any,            // at least one child is true ("OR")
+    negate,         // the only child is false ("NOT")
+    equal,          // column = 'value'
+    not_equal,      // column != 'value'
+    in,             // column IN ('value', 'value', ...)
+    less,           // column < number
+    less_equal,     // column <= number
+    greater,        // column > number
+    greater_equal,  // column >= number
+};
+
+struct node_t {
+    op_t op;
+    std::string column_name;            // as written in the expression, e.g., "PoS" or "#3"
+    std::size_t column = 0;             // resolved from "column_name" by "Predicate::resolve()"
+    std::vector<std::string> values;    // compared against the column
+    std::vector<std::size_t> children;  // indices into "Predicate::nodes"
+    std::vector<double> numbers;        // "values" as numbers, compared against numeric columns
+    bool numeric;                       // compare numbers instead of text, see "Predicate::resolve()"
+};
+
+class Predicate {
+  public:
+    bool parse(const std::string &text);
+    bool resolve(const CsvReader::RowStore &header, const std::vector<Schema::type_t> &types);
+    bool matches(const CsvReader::row_t &row, std::string &buffer) const;
+    bool empty() const;
+
+  private:
+    std::vector<node_t> nodes;  // children always come before their parent, the root is the last node
+    std::string text;
+
+    bool evaluate(const std::size_t idx, const CsvReader::row_t &row, std::string &buffer) const;
+};
+
+// prototypes
+bool find_column(const CsvReader::RowStore &header, const std::string &name, std::size_t &column);
+
+}  // namespace Query
@@ -0,0 +1,117 @@
+#include "Scan.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace Scan {
+
+std::size_t scan_rows(const std::string_view data,
+                      const std::size_t row_begin,
+                      const std::size_t row_limit,
+                      const std::size_t base_offset,
+                      const std::size_t column_count,
+                      std::vector<job_t> &jobs,
+                      Logger::RateLimiter *row_messages,
+                      const match_callback_t &on_match,
+                      const reject_callback_t &on_reject)
+/*
+ * Check all rows that begin in [row_begin, row_limit) of "data" against the target words of every job.
+ * This is the scan loop of the commandline and of "Api::Corpus::query()"; jobs are only read (apart from "found"),
+ * so several chunks can be scanned at the same time, each with its own copy of the jobs.
+ * "base_offset" is the offset of "data" in the input, which "rows_begin" and "rows_end" of the jobs refer to;
+ * offsets passed to the callbacks are offsets in "data".
+ *
+ * Rows are validated while they are split into fields: a row (processed by at least one job) whose amount of columns
+ * is not equal to the header's is passed to "on_reject" and skipped. Valid rows only pay for a comparison per job.
+ * Jobs that need every matching row never skip a word, so the scan only stops early if there are none of them
+ * (or if "on_match" returns False). Per-row debug messages are printed if "row_messages" is set, which caps them.
+ *
+ * Return the amount of target words that are still missing, which is never 0 if a job needs every row.
+ */
+{
+    std::size_t words_left = 0;
+    bool exhaustive = false;
+    for (const job_t &job : jobs) {
+        if (job.exhaustive) {
+            exhaustive = true;
+            continue;
+        }
+        words_left += static_cast<std::size_t>(std::count(job.found.begin(), job.found.end(), false));
+    }
+    CsvReader::Reader reader(data, row_begin);
+    CsvReader::row_t row;
+    std::string key_buffer;    // only used for keys that contain escaped quotes
+    std::string where_buffer;  // same, but for columns used by "where"
+    WordMatcher::Matcher::buffer_t match_buffer;  // normalized keys, only used by "--normalize" and "--max-distance"
+    // counted locally and reported once, so the loop doesn't touch shared memory
+    std::uint64_t rows_parsed = 0;
+    std::uint64_t rows_rejected = 0;
+    std::uint64_t fields_touched = 0;
+    bool stopped = false;
+    const auto has_row = [&](const job_t &job, const std::size_t row_offset) {
+        return base_offset + row_offset >= job.rows_begin && base_offset + row_offset < job.rows_end;
+    };
+    // if no more target words, stop; prevents looping over entire csv
+    while (!stopped && (words_left != 0 || exhaustive) && reader.next_row(row)) {
+        const auto row_offset = static_cast<std::size_t>(row.bytes.data() - data.data());
+        if (row_offset >= row_limit) {
+            break;
+        }
+        ++rows_parsed;
+        fields_touched += row.fields.size();
+        // rows that no job processes (done by an earlier incremental run, or still being written) aren't validated either
+        if (!std::any_of(jobs.begin(), jobs.end(), [&](const job_t &job) { return has_row(job, row_offset); })) {
+            continue;
+        }
+        if (row.fields.size() != column_count) {
+            ++rows_rejected;
+            on_reject(row_offset, row);
+            continue;
+        }
+        for (std::size_t job_idx = 0; job_idx != jobs.size() && !stopped; ++job_idx) {
+            job_t &job = jobs[job_idx];
+            // rows that an incremental job processed before (or that are still being written) are skipped
+            if (!has_row(job, row_offset)) {
+                continue;
+            }
+            // every column is within bounds, because the row has as many columns as the header
+            const std::string_view column_word = CsvReader::field_value(row.fields[job.column], key_buffer);
+            if (row_messages != nullptr && row_messages->allow()) {
+                // this is really wordy, but ensures that the user knows what's going on
+                Logger::debug() << "checking if the word at column no. '"
+                                << job.column << "', which, based on the index, is equal to '"
+                                << column_word << "', is a target word.";
+            }
+            // if matches the word at that specific column (e.g., column 1 is "ability")
+            const std::size_t word_idx = job.matcher->find(column_word, match_buffer);
+            if (word_idx == WordMatcher::Matcher::npos) {
+                continue;
+            }
+            // if already found, ignore the row (so it doesn't match the same word again)
+            const bool first_match = !job.found[word_idx];
+            if (!first_match && !job.exhaustive) {
+                continue;
+            }
+            // the filter only runs for rows whose key matched, so most rows never pay for it
+            if (!job.where->matches(row, where_buffer)) {
+                continue;
+            }
+            if (first_match) {
+                job.found[word_idx] = true;
+                if (!job.exhaustive) {
+                    --words_left;
+                }
+            }
+            stopped = !on_match(job_idx, word_idx, first_match, row_offset, row);
+        }
+    }
+    Stats::add(Stats::counter_t::bytes_read, std::min(reader.offset(), row_limit) - row_begin);
+    Stats::add(Stats::counter_t::rows_parsed, rows_parsed);
+    Stats::add(Stats::counter_t::rows_rejected, rows_rejected);
+    Stats::add(Stats::counter_t::fields_touched, fields_touched);
+    Stats::add(Stats::counter_t::comparisons, rows_parsed * jobs.size());
+    return exhaustive ? std::max<std::size_t>(words_left, 1) : words_left;
+}
+
+}  // namespace Scan
@@ -0,0 +1,48 @@
+#pragma once
+
+// libraries
+#include "CsvReader.hpp"
+#include "Logger.hpp"
+#include "Query.hpp"
+#include "WordMatcher.hpp"
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace Scan {
+
+// types
+struct job_t {
+    const WordMatcher::Matcher *matcher;
+    const Query::Predicate *where;                      // empty if rows aren't filtered
+    std::size_t column;                                 // column that contains words
+    bool exhaustive = false;                            // every matching row is reported, not only the first one of each word
+    std::size_t rows_begin = 0;                         // rows outside [rows_begin, rows_end) are left for another run
+    std::size_t rows_end = WordMatcher::Matcher::npos;
+    std::vector<bool> found;                            // one per target word, only words that aren't found yet are reported
+                                                        // (unless "exhaustive")
+};
+
+// called for every matching row that passes the job's filter; return False to stop the scan
+using match_callback_t = std::function<bool(const std::size_t job_idx,
+                                            const std::size_t word_idx,
+                                            const bool first_match,
+                                            const std::size_t row_offset,
+                                            const CsvReader::row_t &row)>;
+// called for every row whose amount of columns is not equal to the header's
+using reject_callback_t = std::function<void(const std::size_t row_offset, const CsvReader::row_t &row)>;
+
+// prototypes
+std::size_t scan_rows(const std::string_view data,
+                      const std::size_t row_begin,
+                      const std::size_t row_limit,
+                      const std::size_t base_offset,
+                      const std::size_t column_count,
+                      std::vector<job_t> &jobs,
+                      Logger::RateLimiter *row_messages,
+                      const match_callback_t &on_match,
+                      const reject_callback_t &on_reject);
+
+}  // namespace Scan
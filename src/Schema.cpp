@@ -0,0 +1,211 @@
+#include "Schema.hpp"
+#include "Logger.hpp"
+#include "Query.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+constexpr std::size_t sample_rows = 1000;  // rows read to guess the type of every column
+
+bool parse_type(const std::string &name, Schema::type_t &type)
+{
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](const unsigned char c) { return std::tolower(c); });
+    if (lower == "text") {
+        type = Schema::type_t::text;
+    }
+    else if (lower == "integer") {
+        type = Schema::type_t::integer;
+    }
+    else if (lower == "real") {
+        type = Schema::type_t::real;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+namespace Schema {
+
+bool parse_integer(const std::string_view text, std::int64_t &number)
+/*
+ * Return True if "text" is entirely a whole number (e.g., "-12"), False otherwise (including overflow).
+ * Nothing is allocated and the locale is ignored, unlike "std::stol".
+ */
+{
+    const char *end = text.data() + text.size();
+    const auto [ptr, ec] = std::from_chars(text.data(), end, number);
+    return ec == std::errc() && ptr == end && !text.empty();
+}
+
+bool parse_real(const std::string_view text, double &number)
+/*
+ * Return True if "text" is entirely a finite number (e.g., "4.25743325884858" or "-1e3"), False otherwise.
+ * "std::from_chars" converts most numbers with a single 64-bit multiplication (Eisel-Lemire), and is exact for the rest.
+ * Words like "nan" or "inf" are not numbers here, because a word list may well contain them.
+ */
+{
+    const char *end = text.data() + text.size();
+    const auto [ptr, ec] = std::from_chars(text.data(), end, number);
+    return ec == std::errc() && ptr == end && !text.empty() && std::isfinite(number);
+}
+
+void format_real(const double number, std::string &out)
+/*
+ * Append the shortest text that reads back as the same number, e.g., "0.1" rather than "0.10000000000000001".
+ */
+{
+    char text[32];
+    const auto [ptr, ec] = std::to_chars(text, text + sizeof(text), number);
+    out.append(text, ec == std::errc() ? ptr : text);
+}
+
+const char *type_name(const type_t type)
+{
+    switch (type) {
+    case type_t::integer:
+        return "integer";
+    case type_t::real:
+        return "real";
+    case type_t::text:
+        break;
+    }
+    return "text";
+}
+
+bool parse(const std::string &text, std::vector<entry_t> &entries)
+/*
+ * Read a comma-separated list of column types, e.g.:
+ * Freq:integer, "LogFreq(Zipf)":real, #0:text
+ *
+ * Columns are written like in "--where": header names (double-quoted if they contain symbols) or "#" followed by an index.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    entries.clear();
+    std::size_t i = 0;
+    const auto skip_spaces = [&]() {
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) {
+            ++i;
+        }
+    };
+    const auto fail = [&](const std::string &expected) {
+        Logger::error() << "invalid '--schema' list '" << text << "': expected " << expected
+                        << " at position " << (i + 1) << ".";
+        return false;
+    };
+    do {
+        skip_spaces();
+        entry_t entry{"", type_t::text};
+        if (i < text.size() && text[i] == '"') {
+            // quotes inside are escaped by doubling them, like in "--where"
+            ++i;
+            while (true) {
+                if (i >= text.size()) {
+                    return fail("a closing quote");
+                }
+                if (text[i] == '"') {
+                    if (i + 1 < text.size() && text[i + 1] == '"') {
+                        entry.column_name += '"';
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                entry.column_name += text[i++];
+            }
+        }
+        else {
+            while (i < text.size() && text[i] != ':' && text[i] != ',' && !std::isspace(static_cast<unsigned char>(text[i]))) {
+                entry.column_name += text[i++];
+            }
+        }
+        if (entry.column_name.empty()) {
+            return fail("a column (e.g., Freq, \"LogFreq(Zipf)\" or #3)");
+        }
+        skip_spaces();
+        if (i >= text.size() || text[i] != ':') {
+            return fail("':' followed by a type");
+        }
+        ++i;
+        skip_spaces();
+        const std::size_t start = i;
+        while (i < text.size() && std::isalpha(static_cast<unsigned char>(text[i]))) {
+            ++i;
+        }
+        if (!parse_type(text.substr(start, i - start), entry.type)) {
+            i = start;
+            return fail("text, integer or real");
+        }
+        entries.push_back(entry);
+        skip_spaces();
+        if (i < text.size() && text[i] != ',') {
+            return fail("',' or the end of the list");
+        }
+    } while (i++ < text.size());
+    return true;
+}
+
+bool apply(const std::vector<entry_t> &entries, const CsvReader::RowStore &header, std::vector<type_t> &types)
+/*
+ * Override inferred column types with the ones given using "--schema".
+ *
+ * Return True if succeeded, False if a column doesn't exist.
+ */
+{
+    for (const entry_t &entry : entries) {
+        std::size_t column;
+        if (!Query::find_column(header, entry.column_name, column)) {
+            Logger::error() << "column '" << entry.column_name << "' used in '--schema' doesn't exist in the header.";
+            return false;
+        }
+        types[column] = entry.type;
+    }
+    return true;
+}
+
+std::vector<type_t> infer(const std::string_view data, const std::size_t start, const std::size_t column_count)
+/*
+ * Guess the type of every column from the first rows after the header (at "start").
+ * A column is numeric if all of its non-empty values in the sample are numbers;
+ * columns without any values in the sample are text.
+ */
+{
+    std::vector<type_t> types(column_count, type_t::integer);
+    std::vector<bool> seen(column_count, false);
+    CsvReader::Reader reader(data, start);
+    CsvReader::row_t row;
+    std::string buffer;
+    for (std::size_t row_idx = 0; row_idx != sample_rows && reader.next_row(row); ++row_idx) {
+        const std::size_t field_amount = std::min(row.fields.size(), column_count);
+        for (std::size_t i = 0; i != field_amount; ++i) {
+            const std::string_view value = CsvReader::field_value(row.fields[i], buffer);
+            if (types[i] == type_t::text || value.empty()) {
+                continue;
+            }
+            seen[i] = true;
+            std::int64_t integer;
+            double real;
+            if (types[i] == type_t::integer && parse_integer(value, integer)) {
+                continue;
+            }
+            types[i] = parse_real(value, real) ? type_t::real : type_t::text;
+        }
+    }
+    for (std::size_t i = 0; i != column_count; ++i) {
+        if (!seen[i]) {
+            types[i] = type_t::text;
+        }
+    }
+    return types;
+}
+
+}  // namespace Schema
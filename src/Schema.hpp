@@ -0,0 +1,35 @@
+#pragma once
+
+// libraries
+#include "CsvReader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace Schema {
+
+// types
+enum class type_t : std::uint32_t {
+    text,     // anything that is not a number
+    integer,  // every non-empty value is a whole number, e.g., "1200"
+    real,     // every non-empty value is a number, e.g., "4.25743325884858"
+};
+
+struct entry_t {
+    std::string column_name;  // e.g., "Freq" or "#3"
+    type_t type;
+};
+
+// prototypes
+bool parse_integer(const std::string_view text, std::int64_t &number);
+bool parse_real(const std::string_view text, double &number);
+void format_real(const double number, std::string &out);
+const char *type_name(const type_t type);
+bool parse(const std::string &text, std::vector<entry_t> &entries);
+bool apply(const std::vector<entry_t> &entries, const CsvReader::RowStore &header, std::vector<type_t> &types);
+std::vector<type_t> infer(const std::string_view data, const std::size_t start, const std::size_t column_count);
+
+}  // namespace Schema
@@ -0,0 +1,387 @@
+#include "Server.hpp"
+#include "Api.hpp"
+#include "ConsoleInput.hpp"
+#include "Logger.hpp"
+#include "Normalizer.hpp"
+#include "Schema.hpp"
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+constexpr std::size_t max_request_size = 1 << 20;  // longer requests are refused, so a client can't exhaust memory
+
+struct corpus_t {
+    std::string name;    // path of the CSV as given by "--csv", which queries use to pick it
+    std::size_t column;  // indexed column, used by queries that don't set "--column"
+    Api::Corpus corpus;
+};
+
+// connected clients waiting for a worker; unlike "InputStream::BufferQueue", any worker may take the next one
+class ClientQueue {
+  private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<int> clients;
+    bool closed = false;
+
+  public:
+    void push(const int client)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            this->clients.push_back(client);
+        }
+        this->ready.notify_one();
+    }
+
+    bool pop(int &client)
+    /*
+     * Wait for the next client.
+     *
+     * Return True if a client was taken, False if the queue was closed.
+     */
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->ready.wait(lock, [this]() { return this->closed || !this->clients.empty(); });
+        if (this->closed) {
+            return false;
+        }
+        client = this->clients.front();
+        this->clients.pop_front();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            this->closed = true;
+        }
+        this->ready.notify_all();
+    }
+};
+
+bool write_all(const int fd, std::string_view data)
+/*
+ * Write "data" entirely, "write()" may take only a part of it at a time.
+ *
+ * Return True if succeeded, False if the other end is gone.
+ */
+{
+    while (!data.empty()) {
+        const ssize_t size = ::write(fd, data.data(), data.size());
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(size));
+    }
+    return true;
+}
+
+class ServerHelper {
+  private:
+    // variables
+    std::deque<corpus_t> corpora;  // deque, because a corpus must never move once it is open
+
+    const corpus_t *find_corpus(const std::string &name) const
+    {
+        for (const corpus_t &corpus : this->corpora) {
+            if (corpus.name == name) {
+                return &corpus;
+            }
+        }
+        return nullptr;
+    }
+
+    bool run_query(const std::vector<std::string> &tokens, std::string &response) const
+    /*
+     * Answer a query of the form "query [OPTION VALUE]... -- WORD...", e.g.:
+     * query --csv data.csv --where "Freq > 10" --all-matches -- apple pear
+     *
+     * Options are named like the commandline ones: "--csv", "--column", "--where", "--schema", "--normalize",
+     * "--max-distance" and "--all-matches"; "--csv" defaults to the first corpus, "--column" to its indexed column.
+     *
+     * Return True if succeeded, False if the query is invalid (the reason is saved to "response").
+     */
+    {
+        const corpus_t *target = &this->corpora.front();
+        Api::query_t query;
+        Normalizer::options_t options;
+        std::int64_t column = -1;
+        std::int64_t max_distance = 0;
+        std::size_t i = 1;
+        for (; i != tokens.size() && tokens[i] != "--"; ++i) {
+            const std::string &name = tokens[i];
+            if (name == "--all-matches") {
+                query.all_matches = true;
+                continue;
+            }
+            if (i + 1 == tokens.size()) {
+                response = "option '" + name + "' doesn't have a value";
+                return false;
+            }
+            const std::string &value = tokens[++i];
+            if (name == "--csv") {
+                target = this->find_corpus(value);
+                if (target == nullptr) {
+                    response = "corpus '" + value + "' isn't loaded";
+                    return false;
+                }
+            }
+            else if (name == "--column" || name == "--max-distance") {
+                std::int64_t &number = (name == "--column") ? column : max_distance;
+                if (!Schema::parse_integer(value, number) || number < 0) {
+                    response = "please provide an integer equal to 0 or above to '" + name + "'";
+                    return false;
+                }
+            }
+            else if (name == "--where") {
+                query.where = value;
+            }
+            else if (name == "--schema") {
+                query.schema = value;
+            }
+            else if (name == "--normalize") {
+                if (!Normalizer::parse_options(value, options)) {
+                    response = "please provide a comma-separated list of 'nfc', 'nfkc', 'case' or 'accents' to '--normalize'";
+                    return false;
+                }
+            }
+            else {
+                response = "unknown option '" + name + "'";
+                return false;
+            }
+        }
+        if (i == tokens.size()) {
+            response = "please separate the target words from the options using '--'";
+            return false;
+        }
+        query.column = (column < 0) ? target->column : static_cast<std::size_t>(column);
+        const std::size_t column_count = target->corpus.get_header().field_count(0);
+        if (query.column >= column_count) {
+            response = "the target column index '" + std::to_string(query.column) +
+                       "' is larger than the total amount of columns '" + std::to_string(column_count) + "'";
+            return false;
+        }
+        const std::vector<std::string> words(tokens.begin() + static_cast<std::ptrdiff_t>(i) + 1, tokens.end());
+        const Api::WordSet word_set(words, options, static_cast<std::size_t>(max_distance));
+        std::vector<Api::match_t> matches;
+        if (!target->corpus.query(word_set, query, matches)) {
+            response = "invalid '--where' or '--schema'";
+            return false;
+        }
+        response = "OK " + std::to_string(matches.size()) + '\n';
+        for (const Api::match_t &match : matches) {
+            response += word_set.word(match.word);
+            response += '\t';
+            response += std::to_string(match.offset);
+            response += '\t';
+            response += std::to_string(match.row.size());
+            response += '\t';
+            response += match.row;
+            response += '\n';
+        }
+        return true;
+    }
+
+    bool answer(const std::string &line, std::string &response) const
+    /*
+     * Answer a single request line: "query ...", "list" or "quit". Empty lines get no response.
+     *
+     * Return True if the client may send more requests, False if it asked to quit.
+     */
+    {
+        response.clear();
+        const std::vector<std::string> tokens = ConsoleInput::split_line(line);
+        if (tokens.empty()) {
+            return true;
+        }
+        if (tokens[0] == "quit") {
+            return false;
+        }
+        if (tokens[0] == "list") {
+            response = "OK " + std::to_string(this->corpora.size()) + '\n';
+            for (const corpus_t &corpus : this->corpora) {
+                response += corpus.name + '\t' + std::to_string(corpus.corpus.get_header().field_count(0)) + '\t' +
+                            std::to_string(corpus.column) + '\n';
+            }
+        }
+        else if (tokens[0] == "query") {
+            if (!this->run_query(tokens, response)) {
+                response = "ERROR " + response + '\n';
+            }
+        }
+        else {
+            response = "ERROR unknown request '" + tokens[0] + "', expected 'query', 'list' or 'quit'\n";
+        }
+        return true;
+    }
+
+  public:
+    bool load(const ConsoleInput::console_args_t &args)
+    /*
+     * Map the CSV of every job into memory once and index the column of the job,
+     * so queries against it only cost a lookup per target word.
+     *
+     * Return True if succeeded, False if failed.
+     */
+    {
+        const std::vector<ConsoleInput::console_args_t> jobs = args.jobs.empty()
+                                                                   ? std::vector<ConsoleInput::console_args_t>{args}
+                                                                   : args.jobs;
+        for (const ConsoleInput::console_args_t &job : jobs) {
+            if (this->find_corpus(job.filename_csv) != nullptr) {
+                continue;
+            }
+            corpus_t &corpus = this->corpora.emplace_back();
+            corpus.name = job.filename_csv;
+            corpus.column = job.word_column_idx;
+            if (!corpus.corpus.open(corpus.name) || !corpus.corpus.build_index(corpus.column)) {
+                Logger::error() << "could not load '" << corpus.name << "'.";
+                return false;
+            }
+            Logger::info() << "loaded '" << corpus.name << "' and indexed column '" << corpus.column << "'.";
+        }
+        return true;
+    }
+
+    void serve_client(const int input, const int output) const
+    /*
+     * Answer newline-separated requests from "input" on "output", until the client quits or disconnects.
+     * A request longer than "max_request_size" is refused and the client is disconnected.
+     */
+    {
+        std::string pending;  // bytes received after the last complete request
+        std::string response;
+        char buffer[1 << 16];
+        while (true) {
+            const std::size_t newline = pending.find('\n');
+            if ((newline == std::string::npos ? pending.size() : newline) > max_request_size) {
+                write_all(output, "ERROR request too long, it may have at most '" + std::to_string(max_request_size) + "' bytes\n");
+                return;
+            }
+            if (newline == std::string::npos) {
+                const ssize_t size = ::read(input, buffer, sizeof(buffer));
+                if (size < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (size <= 0) {
+                    return;
+                }
+                pending.append(buffer, static_cast<std::size_t>(size));
+                continue;
+            }
+            const std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            const bool keep_going = this->answer(line, response);
+            if (!write_all(output, response) || !keep_going) {
+                return;
+            }
+        }
+    }
+
+    bool listen(const std::string &filename, const std::size_t threads) const
+    /*
+     * Accept clients on a Unix domain socket and serve them using "threads" workers, until the process is stopped.
+     *
+     * Return False, as it only returns if the socket failed.
+     */
+    {
+        sockaddr_un address{};
+        if (filename.size() >= sizeof(address.sun_path)) {
+            Logger::error() << "the socket path '" << filename << "' is too long, it may have at most '"
+                            << (sizeof(address.sun_path) - 1) << "' characters.";
+            return false;
+        }
+        // a socket left behind by a server that was killed would make "bind()" fail
+        // (errors are ignored here, "bind()" reports them)
+        std::error_code error;
+        if (std::filesystem::is_socket(filename, error)) {
+            std::filesystem::remove(filename, error);
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, filename.c_str(), filename.size() + 1);
+        const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server < 0 || ::bind(server, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+            ::listen(server, SOMAXCONN) != 0) {
+            Logger::error() << "could not listen on '" << filename << "': " << std::strerror(errno) << ".";
+            if (server >= 0) {
+                ::close(server);
+            }
+            return false;
+        }
+        Logger::info() << "listening on '" << filename << "' with '" << threads << "' workers.";
+        ClientQueue clients;
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i != threads; ++i) {
+            workers.emplace_back([this, &clients]() {
+                int client;
+                while (clients.pop(client)) {
+                    this->serve_client(client, client);
+                    ::close(client);
+                }
+            });
+        }
+        while (true) {
+            const int client = ::accept(server, nullptr, nullptr);
+            if (client < 0 && errno == EINTR) {
+                continue;
+            }
+            if (client < 0) {
+                Logger::error() << "could not accept a client on '" << filename << "': " << std::strerror(errno) << ".";
+                break;
+            }
+            clients.push(client);
+        }
+        clients.close();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        ::close(server);
+        return false;
+    }
+};
+
+namespace Server {
+
+bool serve(const ConsoleInput::console_args_t &args)
+/*
+ * Load the CSV of every job once, then answer queries against them until stopped, either on stdin/stdout
+ * (one client, which quits by closing stdin or sending "quit") or on the Unix domain socket "--socket".
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    // a client that disconnects halfway through a response must not stop the server
+    std::signal(SIGPIPE, SIG_IGN);
+    const bool use_stdin = args.filename_socket.empty();
+    if (use_stdin) {
+        // responses are written to stdout, so only errors may be printed (to stderr)
+        Logger::set_level(Logger::level_t::error);
+    }
+    ServerHelper helper;
+    if (!helper.load(args)) {
+        return false;
+    }
+    if (use_stdin) {
+        helper.serve_client(STDIN_FILENO, STDOUT_FILENO);
+        return true;
+    }
+    return helper.listen(args.filename_socket, args.threads);
+}
+
+}  // namespace Server
@@ -0,0 +1,12 @@
+#pragma once
+
+// libraries
+#include "ConsoleInput.hpp"
+
+// custom namespace
+namespace Server {
+
+// prototypes
+bool serve(const ConsoleInput::console_args_t &args);
+
+}  // namespace Server
@@ -0,0 +1,130 @@
+#include "Stats.hpp"
+#include "DiskManager.hpp"
+#include <array>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// relaxed atomics are enough, values are only read after all worker threads are joined
+std::atomic<bool> enabled{false};
+std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Stats::counter_t::count)> counters{};
+std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Stats::phase_t::count)> phase_nanoseconds{};
+const std::chrono::steady_clock::time_point program_start = std::chrono::steady_clock::now();
+
+constexpr const char *phase_names[] = {"load_words", "split", "index_lookup", "scan", "write"};
+constexpr const char *counter_names[] = {"bytes_read", "rows_parsed", "rows_rejected", "fields_touched",
+                                         "comparisons", "matches", "bytes_written", "allocations"};
+
+std::uint64_t get(const Stats::counter_t counter)
+{
+    return counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+double phase_seconds(const std::size_t phase)
+{
+    return static_cast<double>(phase_nanoseconds[phase].load(std::memory_order_relaxed)) / 1e9;
+}
+
+}  // namespace
+
+namespace Stats {
+
+PhaseTimer::PhaseTimer(const phase_t phase)
+/*
+ * Class constructor.
+ *
+ * Start timing "phase" (using a monotonic clock); the time is added when the timer goes out of scope.
+ */
+    : phase(phase), active(is_enabled())
+{
+    if (this->active) {
+        this->start = std::chrono::steady_clock::now();
+    }
+}
+
+PhaseTimer::~PhaseTimer()
+/*
+ * Class destructor.
+ */
+{
+    if (this->active) {
+        const auto elapsed = std::chrono::steady_clock::now() - this->start;
+        phase_nanoseconds[static_cast<std::size_t>(this->phase)].fetch_add(
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+            std::memory_order_relaxed);
+    }
+}
+
+void enable()
+{
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+bool is_enabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void add(const counter_t counter, const std::uint64_t amount)
+/*
+ * Add "amount" to "counter". Hot loops should count locally and call this once per chunk.
+ */
+{
+    if (is_enabled()) {
+        counters[static_cast<std::size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+}
+
+void print_summary()
+/*
+ * Print all phase times and counters in a human-readable form.
+ */
+{
+    const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - program_start).count();
+    std::cout << "STATS: phases (seconds):\n";
+    for (std::size_t i = 0; i != phase_nanoseconds.size(); ++i) {
+        std::cout << "  " << std::left << std::setw(16) << phase_names[i] << std::fixed << std::setprecision(6)
+                  << phase_seconds(i) << '\n';
+    }
+    std::cout << "  " << std::left << std::setw(16) << "total" << total << '\n';
+    std::cout << "STATS: counters:\n";
+    for (std::size_t i = 0; i != counters.size(); ++i) {
+        std::cout << "  " << std::left << std::setw(16) << counter_names[i]
+                  << counters[i].load(std::memory_order_relaxed) << '\n';
+    }
+    const double scan = phase_seconds(static_cast<std::size_t>(phase_t::scan));
+    if (scan > 0.0) {
+        std::cout << "STATS: scan throughput: " << std::setprecision(1)
+                  << (static_cast<double>(get(counter_t::bytes_read)) / 1e6 / scan) << " MB/s, "
+                  << (static_cast<double>(get(counter_t::rows_parsed)) / scan) << " rows/s.\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+bool save_json(const std::string &filename)
+/*
+ * Save all phase times and counters as a single JSON object.
+ *
+ * Return True if succeeded, False if failed.
+ */
+{
+    const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - program_start).count();
+    std::ostringstream json;
+    json << std::setprecision(9) << "{\"phases\":{";
+    for (std::size_t i = 0; i != phase_nanoseconds.size(); ++i) {
+        json << (i == 0 ? "" : ",") << '"' << phase_names[i] << "\":" << phase_seconds(i);
+    }
+    json << ",\"total\":" << total << "},\"counters\":{";
+    for (std::size_t i = 0; i != counters.size(); ++i) {
+        json << (i == 0 ? "" : ",") << '"' << counter_names[i] << "\":" << counters[i].load(std::memory_order_relaxed);
+    }
+    json << "}}\n";
+    DiskManager::BufferedWriter writer(filename);
+    writer.write(json.str());
+    return writer.flush();
+}
+
+}  // namespace Stats
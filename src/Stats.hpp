@@ -0,0 +1,54 @@
+#pragma once
+
+// libraries
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// custom namespace
+namespace Stats {
+
+// types
+enum class phase_t {
+    load_words,    // reading words files and building matchers
+    split,         // finding chunk boundaries for "--threads"
+    index_lookup,  // looking up words in sidecar indexes
+    scan,          // parsing rows and matching them against target words
+    write,         // re-reading matching rows and writing them to output files
+    count,
+};
+
+enum class counter_t {
+    bytes_read,      // bytes of CSV that were scanned
+    rows_parsed,     // rows split into fields
+    rows_rejected,   // rows skipped, because their amount of columns is not equal to the header's
+    fields_touched,  // fields produced by the tokenizer
+    comparisons,     // hash table lookups
+    matches,         // rows written to output files
+    bytes_written,   // bytes written to output files
+    allocations,     // calls to "operator new" (only counted by the commandline, see "main.cpp")
+    count,
+};
+
+class PhaseTimer {
+  public:
+    explicit PhaseTimer(const phase_t phase);
+    ~PhaseTimer();
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  private:
+    phase_t phase;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+// prototypes
+void enable();
+bool is_enabled();
+void add(const counter_t counter, const std::uint64_t amount);
+void print_summary();
+bool save_json(const std::string &filename);
+
+}  // namespace Stats
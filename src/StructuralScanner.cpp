@@ -0,0 +1,263 @@
+#include "StructuralScanner.hpp"
+#include <bit>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STRUCTURAL_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void scan_scalar(const char *block, StructuralScanner::block_masks_t &masks)
+/*
+ * Portable fallback, one byte at a time.
+ */
+{
+    masks = StructuralScanner::block_masks_t{0, 0, 0};
+    for (std::size_t i = 0; i < 64; ++i) {
+        const std::uint64_t bit = std::uint64_t{1} << i;
+        switch (block[i]) {
+        case '"':
+            masks.quote |= bit;
+            break;
+        case ',':
+            masks.delimiter |= bit;
+            break;
+        case '\n':
+            masks.newline |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+#ifdef STRUCTURAL_SCANNER_X86
+__attribute__((target("sse2"))) void scan_sse2(const char *block, StructuralScanner::block_masks_t &masks)
+/*
+ * Compare 16 bytes at a time, four loads per block.
+ */
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i delimiter = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    masks = StructuralScanner::block_masks_t{0, 0, 0};
+    for (int i = 0; i < 4; ++i) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16));
+        const int shift = i * 16;
+        masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << shift;
+        masks.delimiter |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delimiter)))) << shift;
+        masks.newline |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)))) << shift;
+    }
+}
+
+__attribute__((target("avx2"))) std::uint64_t combine(const __m256i lo, const __m256i hi)
+/*
+ * Join the byte masks of two 32-byte halves into a 64-bit mask.
+ */
+{
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(lo))) |
+           (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(hi))) << 32);
+}
+
+__attribute__((target("avx2"))) void scan_avx2(const char *block, StructuralScanner::block_masks_t &masks)
+/*
+ * Compare 32 bytes at a time, two loads per block.
+ */
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i delimiter = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+    masks.quote = combine(_mm256_cmpeq_epi8(lo, quote), _mm256_cmpeq_epi8(hi, quote));
+    masks.delimiter = combine(_mm256_cmpeq_epi8(lo, delimiter), _mm256_cmpeq_epi8(hi, delimiter));
+    masks.newline = combine(_mm256_cmpeq_epi8(lo, newline), _mm256_cmpeq_epi8(hi, newline));
+}
+#endif
+
+std::uint64_t classify_scalar(const char *block, const std::size_t length, StructuralScanner::state_t &state)
+/*
+ * Return the separators of a block that are outside quotes, one byte at a time, and update "state" to its end.
+ * Only used for blocks where a '"' appears in the middle of an unquoted field, which is plain text there.
+ */
+{
+    using StructuralScanner::state_t;
+    std::uint64_t separators = 0;
+    for (std::size_t i = 0; i != length; ++i) {
+        const char c = block[i];
+        if (state == state_t::quoted) {
+            // a quote either closes the field or, if another one follows, is escaped
+            if (c == '"') {
+                state = state_t::field_start;
+            }
+            continue;
+        }
+        if (c == ',' || c == '\n') {
+            separators |= std::uint64_t{1} << i;
+            state = state_t::field_start;
+        }
+        else if (c == '"' && state == state_t::field_start) {
+            state = state_t::quoted;
+        }
+        else {
+            state = state_t::unquoted;
+        }
+    }
+    return separators;
+}
+
+std::uint64_t classify(const char *block, const std::size_t length, const StructuralScanner::block_masks_t &masks, StructuralScanner::state_t &state)
+/*
+ * Return the separators of a block (its first "length" bytes) that are outside quotes, and update "state" to its end.
+ *
+ * Every '"' toggles the quote state (see "prefix_xor()"), which is only right if quotes open fields.
+ * A quote that opens a quoted field must follow a separator, or be the second half of an escaped quote (""),
+ * so a block with any other opening quote (e.g., '5" screen') is classified one byte at a time instead.
+ */
+{
+    using StructuralScanner::state_t;
+    const std::uint64_t carry = (state == state_t::quoted) ? ~std::uint64_t{0} : 0;
+    const std::uint64_t in_quote = StructuralScanner::prefix_xor(masks.quote) ^ carry;
+    const std::uint64_t boundaries = masks.delimiter | masks.newline | masks.quote;
+    const std::uint64_t in_quote_before = (in_quote << 1) | (carry & 1);
+    const std::uint64_t may_open = (boundaries << 1) | (state == state_t::field_start ? 1 : 0);
+    if ((masks.quote & ~in_quote_before & ~may_open) != 0) {
+        return classify_scalar(block, length, state);
+    }
+    const std::size_t last = length - 1;
+    if ((in_quote >> last) & 1) {
+        state = state_t::quoted;
+    }
+    else {
+        state = ((boundaries >> last) & 1) ? state_t::field_start : state_t::unquoted;
+    }
+    return (masks.delimiter | masks.newline) & ~in_quote;
+}
+
+}  // namespace
+
+namespace StructuralScanner {
+
+kernel_t select_kernel()
+/*
+ * Pick the widest kernel supported by the CPU (checked once, using CPUID).
+ */
+{
+#ifdef STRUCTURAL_SCANNER_X86
+    static const kernel_t kernel = []() -> kernel_t {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return scan_avx2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return scan_sse2;
+        }
+        return scan_scalar;
+    }();
+    return kernel;
+#else
+    return scan_scalar;
+#endif
+}
+
+const char *kernel_name()
+{
+#ifdef STRUCTURAL_SCANNER_X86
+    if (select_kernel() == scan_avx2) {
+        return "avx2";
+    }
+    if (select_kernel() == scan_sse2) {
+        return "sse2";
+    }
+#endif
+    return "scalar";
+}
+
+std::uint64_t prefix_xor(std::uint64_t bits)
+/*
+ * Bit i of the result is the XOR of bits 0..i of the input.
+ * Applied to the quote mask, it marks every byte that is inside quotes (including the opening quote).
+ * Escaped quotes ("") toggle twice, so they don't need any special handling; quotes in the middle of
+ * unquoted fields do, see "classify()".
+ */
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+state_t scan_state(const std::string_view data, state_t state)
+/*
+ * Return the state at the end of "data", if it begins in "state".
+ */
+{
+    const kernel_t kernel = select_kernel();
+    block_masks_t masks;
+    std::size_t pos = 0;
+    for (; pos + 64 <= data.size(); pos += 64) {
+        kernel(data.data() + pos, masks);
+        classify(data.data() + pos, 64, masks, state);
+    }
+    if (pos < data.size()) {
+        char tail[64] = {};
+        std::memcpy(tail, data.data() + pos, data.size() - pos);
+        kernel(tail, masks);
+        classify(tail, data.size() - pos, masks, state);
+    }
+    return state;
+}
+
+Scanner::Scanner(const std::string_view data, const std::size_t start, const state_t state)
+/*
+ * Class constructor.
+ *
+ * Scan "data" from "start" onwards; "state" tells where "start" lies within a row (e.g., inside a quoted field).
+ */
+    : data(data), kernel(select_kernel()), block_pos(start), state(state)
+{
+}
+
+void Scanner::load_block()
+/*
+ * Classify the next 64 bytes and keep only the delimiters and newlines that are outside quotes.
+ */
+{
+    block_masks_t masks;
+    const std::size_t remaining = this->data.size() - this->block_pos;
+    if (remaining >= 64) {
+        this->kernel(this->data.data() + this->block_pos, masks);
+        this->separators = classify(this->data.data() + this->block_pos, 64, masks, this->state);
+    }
+    else {
+        // pad the tail with zeros, which are never structural
+        char tail[64] = {};
+        std::memcpy(tail, this->data.data() + this->block_pos, remaining);
+        this->kernel(tail, masks);
+        this->separators = classify(tail, remaining, masks, this->state);
+    }
+    this->block_pos += 64;
+}
+
+std::size_t Scanner::next()
+/*
+ * Return the offset of the next unquoted ',' or '\n', or the size of the data if there are none left.
+ */
+{
+    while (this->separators == 0) {
+        if (this->block_pos >= this->data.size()) {
+            return this->data.size();
+        }
+        this->load_block();
+    }
+    const std::size_t offset = this->block_pos - 64 + static_cast<std::size_t>(std::countr_zero(this->separators));
+    this->separators &= this->separators - 1;
+    return offset;
+}
+
+}  // namespace StructuralScanner
@@ -0,0 +1,50 @@
+#pragma once
+
+// libraries
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// custom namespace
+namespace StructuralScanner {
+
+// types
+struct block_masks_t {
+    std::uint64_t quote;      // bit i is set if byte i of the block is '"'
+    std::uint64_t delimiter;  // bit i is set if byte i of the block is ','
+    std::uint64_t newline;    // bit i is set if byte i of the block is '\n'
+};
+
+using kernel_t = void (*)(const char *block, block_masks_t &masks);
+
+// where a byte lies within a row, which decides whether a '"' opens, escapes or closes a quoted field
+enum class state_t {
+    field_start,  // at the start of a field (or right after a quote that may close one), where '"' opens a quoted field
+    unquoted,     // inside an unquoted field (or after the closing quote of a quoted one), where '"' is plain text
+    quoted,       // inside a quoted field, where only '"' is special
+};
+
+class Scanner {
+  public:
+    Scanner(const std::string_view data, const std::size_t start, const state_t state = state_t::field_start);
+
+    std::size_t next();
+
+  private:
+    // variables
+    std::string_view data;
+    kernel_t kernel;
+    std::size_t block_pos = 0;       // offset of the block after the current one in "data"
+    std::uint64_t separators = 0;    // unquoted ',' and '\n' that were not returned yet
+    state_t state;                   // state at "block_pos"
+
+    void load_block();
+};
+
+// prototypes
+kernel_t select_kernel();
+const char *kernel_name();
+std::uint64_t prefix_xor(std::uint64_t bits);
+state_t scan_state(const std::string_view data, const state_t state);
+
+}  // namespace StructuralScanner
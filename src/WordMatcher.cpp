@@ -0,0 +1,305 @@
+#include "WordMatcher.hpp"
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace {
+
+constexpr std::size_t prefetch_distance = 16;  // words between prefetching a slot and inserting into it
+
+std::size_t edit_distance(const std::u32string &a, const std::u32string &b, std::vector<std::size_t> &row)
+/*
+ * Return the Levenshtein distance between "a" and "b", counted in code points.
+ * Only a single row of the matrix is kept, in "row".
+ */
+{
+    row.resize(b.size() + 1);
+    for (std::size_t j = 0; j <= b.size(); ++j) {
+        row[j] = j;
+    }
+    for (std::size_t i = 1; i <= a.size(); ++i) {
+        std::size_t diagonal = row[0];
+        row[0] = i;
+        for (std::size_t j = 1; j <= b.size(); ++j) {
+            const std::size_t above = row[j];
+            row[j] = std::min({above + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+}  // namespace
+
+namespace WordMatcher {
+
+Matcher::Matcher(const std::vector<std::string_view> &words, const Normalizer::options_t &options, const std::size_t max_distance)
+/*
+ * Class constructor.
+ *
+ * Build an open-addressing hash table (linear probing) over the target words.
+ * The table is kept at most half full, so a lookup touches one or two slots on average.
+ * Unique words are copied back to back into a single buffer, so "words" may point into a file that is unmapped afterwards,
+ * and millions of words cost one allocation instead of one each.
+ * Duplicate words are stored once and recorded, see "get_duplicates()".
+ *
+ * With normalization, the table holds normalized words (two words that normalize the same are duplicates),
+ * and "word()" still returns the words as written in the words file.
+ * With "max_distance", a BK-tree is built over the normalized words as well.
+ */
+    : options(options), max_distance(max_distance)
+{
+    const std::size_t capacity = std::bit_ceil(std::max<std::size_t>(words.size() * 2, 16));
+    this->slots.assign(capacity, slot_t{0, 0});
+    this->slot_mask = capacity - 1;
+    std::size_t pool_size = 0;
+    for (const std::string_view word : words) {
+        pool_size += word.size() + 1;
+    }
+    this->pool.reserve(pool_size);
+    this->word_begins.reserve(words.size() + 1);
+    this->word_begins.push_back(0);
+    const bool normalized = Normalizer::is_enabled(options);
+    std::string key;
+    for (std::size_t position = 0; position != words.size(); ++position) {
+        const std::string_view word = words[position];
+        // with millions of words the table is far larger than the caches, so fetch the slot of a word
+        // a few positions ahead while this one is inserted (normalized words are too slow for that to matter)
+        if (!normalized && position + prefetch_distance < words.size()) {
+            const std::size_t ahead = std::hash<std::string_view>{}(words[position + prefetch_distance]);
+            __builtin_prefetch(&this->slots[ahead & this->slot_mask]);
+        }
+        if (normalized) {
+            Normalizer::normalize(word, options, key);
+        }
+        const std::string_view lookup = normalized ? std::string_view(key) : word;
+        const std::size_t hash = std::hash<std::string_view>{}(lookup);
+        const std::size_t pos = this->probe(lookup, hash);
+        if (this->slots[pos].idx != 0) {
+            this->duplicates.push_back(duplicate_t{position, this->slots[pos].idx - std::size_t{1}});
+            continue;
+        }
+        // the terminator lets "word()" be handed to C strings as-is (e.g., by the C API)
+        this->pool.append(word);
+        this->pool.push_back('\0');
+        this->word_begins.push_back(this->pool.size());
+        if (normalized) {
+            this->keys.push_back(key);
+        }
+        this->slots[pos] = slot_t{static_cast<std::uint32_t>(hash >> 32), static_cast<std::uint32_t>(this->size())};
+    }
+    this->found_bits.assign((this->size() + 63) / 64, 0);
+    if (max_distance != 0) {
+        this->points.resize(this->size());
+        this->bk_nodes.reserve(this->size());
+        for (std::size_t i = 0; i != this->size(); ++i) {
+            Normalizer::decode(this->key(i), this->points[i]);
+            this->insert_bk(static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+Matcher::Matcher(const std::vector<std::string> &words, const Normalizer::options_t &options, const std::size_t max_distance)
+/*
+ * Class constructor, for words that are already in memory (e.g., passed to the API).
+ */
+    : Matcher(std::vector<std::string_view>(words.begin(), words.end()), options, max_distance)
+{
+}
+
+std::string_view Matcher::key(const std::size_t idx) const
+{
+    return this->keys.empty() ? this->word(idx) : std::string_view(this->keys[idx]);
+}
+
+void Matcher::insert_bk(const std::uint32_t idx)
+/*
+ * Add a word to the BK-tree: walk down the children whose distance to their parent equals
+ * the distance between the new word and that parent, until there is no such child.
+ */
+{
+    const auto node_idx = static_cast<std::uint32_t>(this->bk_nodes.size());
+    if (node_idx == 0) {
+        this->bk_nodes.push_back(bk_node_t{idx, 0, 0, 0});
+        return;
+    }
+    std::vector<std::size_t> row;
+    std::uint32_t parent = 0;
+    while (true) {
+        const auto distance = static_cast<std::uint32_t>(edit_distance(this->points[idx], this->points[this->bk_nodes[parent].word], row));
+        std::uint32_t child = this->bk_nodes[parent].first_child;
+        while (child != 0 && this->bk_nodes[child].distance != distance) {
+            child = this->bk_nodes[child].next_sibling;
+        }
+        if (child == 0) {
+            this->bk_nodes.push_back(bk_node_t{idx, distance, 0, this->bk_nodes[parent].first_child});
+            this->bk_nodes[parent].first_child = node_idx;
+            return;
+        }
+        parent = child;
+    }
+}
+
+std::size_t Matcher::find_nearest(buffer_t &buffer) const
+/*
+ * Return the index of the word closest to the normalized key in "buffer", if it is at most "max_distance" away,
+ * or "npos" otherwise. Ties are resolved in favour of the word that comes first in the words file.
+ *
+ * Thanks to the triangle inequality, only children whose distance to their parent is within "max_distance"
+ * of the distance between the key and that parent can hold a close enough word.
+ */
+{
+    if (this->bk_nodes.empty()) {
+        return npos;
+    }
+    Normalizer::decode(buffer.key, buffer.points);
+    std::size_t best = npos;
+    std::size_t best_distance = this->max_distance + 1;
+    buffer.pending.assign(1, 0);
+    while (!buffer.pending.empty()) {
+        const bk_node_t &node = this->bk_nodes[buffer.pending.back()];
+        buffer.pending.pop_back();
+        const std::size_t distance = edit_distance(buffer.points, this->points[node.word], buffer.distances);
+        if (distance < best_distance || (distance == best_distance && node.word < best)) {
+            best = node.word;
+            best_distance = distance;
+        }
+        for (std::uint32_t child = node.first_child; child != 0; child = this->bk_nodes[child].next_sibling) {
+            const std::size_t child_distance = this->bk_nodes[child].distance;
+            if (child_distance + this->max_distance >= distance && child_distance <= distance + this->max_distance) {
+                buffer.pending.push_back(child);
+            }
+        }
+    }
+    return best;
+}
+
+std::size_t Matcher::probe(const std::string_view key, const std::size_t hash) const
+/*
+ * Return the slot that either holds "key" or is the empty slot where it would be inserted.
+ */
+{
+    const auto tag = static_cast<std::uint32_t>(hash >> 32);
+    std::size_t pos = hash & this->slot_mask;
+    while (true) {
+        const slot_t &slot = this->slots[pos];
+        if (slot.idx == 0 || (slot.tag == tag && this->key(slot.idx - 1) == key)) {
+            return pos;
+        }
+        pos = (pos + 1) & this->slot_mask;
+    }
+}
+
+std::size_t Matcher::find(const std::string_view key) const
+/*
+ * Return the index of "key" among the target words, or "npos" if it is not a target word.
+ * "key" is compared as-is, see the overload below for normalization and edit distance.
+ */
+{
+    const std::size_t idx = this->slots[this->probe(key, std::hash<std::string_view>{}(key))].idx;
+    return (idx == 0) ? npos : idx - 1;
+}
+
+std::size_t Matcher::find(const std::string_view key, buffer_t &buffer) const
+/*
+ * Return the index of the target word that "key" matches, or "npos" if there is none.
+ * "key" is normalized first (into "buffer", so nothing is allocated once it's large enough).
+ * If there is no exact match and "max_distance" is set, the closest word within that distance matches.
+ */
+{
+    if (this->is_exact()) {
+        return this->find(key);
+    }
+    if (!Normalizer::is_enabled(this->options)) {
+        buffer.key.assign(key);
+    }
+    else {
+        Normalizer::normalize(key, this->options, buffer.key);
+    }
+    const std::size_t idx = this->find(buffer.key);
+    if (idx != npos || this->max_distance == 0) {
+        return idx;
+    }
+    return this->find_nearest(buffer);
+}
+
+bool Matcher::is_exact() const
+/*
+ * Return True if keys are compared as-is (no normalization, no edit distance), False otherwise.
+ */
+{
+    return !Normalizer::is_enabled(this->options) && this->max_distance == 0;
+}
+
+bool Matcher::mark_found(const std::size_t idx)
+/*
+ * Mark the word at "idx" as found.
+ *
+ * Return True if it was not found before (i.e., this is the first match), False otherwise.
+ */
+{
+    std::uint64_t &bits = this->found_bits[idx / 64];
+    const std::uint64_t bit = std::uint64_t{1} << (idx % 64);
+    if (bits & bit) {
+        return false;
+    }
+    bits |= bit;
+    ++this->found;
+    return true;
+}
+
+bool Matcher::is_found(const std::size_t idx) const
+{
+    return (this->found_bits[idx / 64] >> (idx % 64)) & 1;
+}
+
+bool Matcher::all_found() const
+{
+    return this->found == this->size();
+}
+
+std::size_t Matcher::size() const
+{
+    return this->word_begins.size() - 1;
+}
+
+std::size_t Matcher::found_count() const
+{
+    return this->found;
+}
+
+std::size_t Matcher::duplicate_count() const
+{
+    return this->duplicates.size();
+}
+
+const std::vector<Matcher::duplicate_t> &Matcher::get_duplicates() const
+{
+    return this->duplicates;
+}
+
+std::string_view Matcher::word(const std::size_t idx) const
+/*
+ * Return the target word at "idx" as written in the words file; it is followed by '\0', so "data()" is a C string.
+ */
+{
+    const std::size_t begin = this->word_begins[idx];
+    return std::string_view(this->pool.data() + begin, this->word_begins[idx + 1] - begin - 1);
+}
+
+std::vector<std::size_t> Matcher::missing() const
+/*
+ * Return indices of all words that were not found, in the order of the words file.
+ */
+{
+    std::vector<std::size_t> result;
+    result.reserve(this->size() - this->found);
+    for (std::size_t i = 0; i != this->size(); ++i) {
+        if (!this->is_found(i)) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+}  // namespace WordMatcher
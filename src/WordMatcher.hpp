@@ -0,0 +1,82 @@
+#pragma once
+
+// libraries
+#include "Normalizer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// custom namespace
+namespace WordMatcher {
+
+// types
+class Matcher {
+  public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // scratch space for "find()" with normalization or edit distance, one per thread
+    struct buffer_t {
+        std::string key;                     // normalized key
+        std::u32string points;               // code points of the normalized key
+        std::vector<std::size_t> distances;  // one row of the edit distance matrix
+        std::vector<std::uint32_t> pending;  // BK-tree nodes left to visit
+    };
+
+    struct duplicate_t {
+        std::size_t position;  // index of the duplicate in the list of words passed to the constructor
+        std::size_t word;      // index of the target word it duplicates
+    };
+
+    explicit Matcher(const std::vector<std::string_view> &words, const Normalizer::options_t &options = {}, const std::size_t max_distance = 0);
+    explicit Matcher(const std::vector<std::string> &words, const Normalizer::options_t &options = {}, const std::size_t max_distance = 0);
+
+    std::size_t find(const std::string_view key) const;
+    std::size_t find(const std::string_view key, buffer_t &buffer) const;
+    bool is_exact() const;
+    bool mark_found(const std::size_t idx);
+    bool is_found(const std::size_t idx) const;
+    bool all_found() const;
+    std::size_t size() const;
+    std::size_t found_count() const;
+    std::size_t duplicate_count() const;
+    const std::vector<duplicate_t> &get_duplicates() const;
+    std::string_view word(const std::size_t idx) const;
+    std::vector<std::size_t> missing() const;
+
+  private:
+    // types
+    struct slot_t {
+        std::uint32_t tag;  // upper bits of the hash, cheap pre-check before comparing strings
+        std::uint32_t idx;  // index into "words" plus one, 0 means the slot is empty
+    };
+
+    struct bk_node_t {
+        std::uint32_t word;          // index into "words"
+        std::uint32_t distance;      // edit distance to the parent
+        std::uint32_t first_child;   // 0 means no child (the root is never a child)
+        std::uint32_t next_sibling;  // 0 means no more siblings
+    };
+
+    // variables
+    std::string pool;                      // unique target words back to back, each followed by '\0'
+    std::vector<std::size_t> word_begins;  // offset of every word in "pool", followed by the size of "pool"
+    std::vector<std::string> keys;         // normalized "words", empty if there is no normalization
+    std::vector<std::u32string> points;    // code points of the keys, only for edit distance
+    std::vector<bk_node_t> bk_nodes;       // BK-tree over the keys, only for edit distance
+    Normalizer::options_t options;
+    std::size_t max_distance = 0;
+    std::vector<slot_t> slots;             // open-addressing table, power-of-two sized
+    std::vector<std::uint64_t> found_bits;  // one bit per word
+    std::size_t slot_mask = 0;
+    std::size_t found = 0;
+    std::vector<duplicate_t> duplicates;   // in the order of the words file
+
+    std::string_view key(const std::size_t idx) const;
+    std::size_t probe(const std::string_view key, const std::size_t hash) const;
+    void insert_bk(const std::uint32_t idx);
+    std::size_t find_nearest(buffer_t &buffer) const;
+};
+
+}  // namespace WordMatcher
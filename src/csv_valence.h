@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+ * C interface of "libcsv_valence", for callers that can't use the C++ API in "Api.hpp" (e.g., other languages).
+ *
+ * Open a corpus and prepare a word set once, then run any amount of queries against them, also from several threads.
+ * Strings that are returned point into the corpus or the word set, and stay valid until it is closed or freed.
+ */
+
+// libraries
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+typedef struct csv_valence_corpus csv_valence_corpus;
+typedef struct csv_valence_words csv_valence_words;
+
+typedef struct csv_valence_query {
+    size_t column;       // column that contains words, same as "--column"
+    const char *where;   // same syntax as "--where", NULL or "" if rows aren't filtered
+    const char *schema;  // same syntax as "--schema", NULL or "" if column types are only inferred
+    int all_matches;     // non-zero for every matching row instead of the first one of each target word
+} csv_valence_query;
+
+typedef struct csv_valence_field {
+    const char *data;  // value without surrounding quotes, NOT null-terminated
+    size_t size;
+    int escaped;       // non-zero if the value still contains doubled quotes ("")
+} csv_valence_field;
+
+typedef struct csv_valence_match {
+    size_t word;                      // index of the target word, see "csv_valence_words_get()"
+    size_t offset;                    // byte offset of the row in the CSV file
+    const char *row;                  // entire row as it appears in the CSV file, NOT null-terminated
+    size_t row_size;
+    const csv_valence_field *fields;  // only valid during the callback
+    size_t field_count;
+} csv_valence_match;
+
+// called for every match, in the order of the CSV file; return 0 to stop the query early
+typedef int (*csv_valence_callback)(const csv_valence_match *match, void *user_data);
+
+// prototypes
+int csv_valence_set_log_level(const char *level);
+csv_valence_corpus *csv_valence_open(const char *filename);
+void csv_valence_close(csv_valence_corpus *corpus);
+size_t csv_valence_column_count(const csv_valence_corpus *corpus);
+const char *csv_valence_column_name(const csv_valence_corpus *corpus, size_t column, size_t *size);
+csv_valence_words *csv_valence_words_new(const char *const *words, size_t count, const char *normalize, size_t max_distance);
+void csv_valence_words_free(csv_valence_words *words);
+size_t csv_valence_words_size(const csv_valence_words *words);
+const char *csv_valence_words_get(const csv_valence_words *words, size_t idx);
+long long csv_valence_run(const csv_valence_corpus *corpus,
+                          const csv_valence_words *words,
+                          const csv_valence_query *query,
+                          csv_valence_callback callback,
+                          void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,6 +1,30 @@
 #include "ConsoleInput.hpp"
+#include "Logger.hpp"
 #include "ProcessCSV.hpp"
-#include <iostream>
+#include "Server.hpp"
+#include "Stats.hpp"
+#include <cstdlib>
+#include <new>
+
+// count allocations for "--stats"; lives here instead of in the library, so programs embedding it keep their own "operator new"
+void *operator new(std::size_t size)
+{
+    Stats::add(Stats::counter_t::allocations, 1);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
 
 int main(int argc, char *argv[])
 {
@@ -12,13 +36,44 @@ int main(int argc, char *argv[])
     args.filename_csv = "data.csv";       // file must exist
     args.filename_output = "output.csv";  // file created if doesn't exist
     args.word_column_idx = 1;             // column in CSV from which words are read
+    args.output_format = OutputWriter::format_t::raw;  // rows are saved exactly as they appear in the CSV
+    args.max_distance = 0;                // keys must match target words exactly
+    args.all_matches = false;             // toggle, save every matching row instead of the first one
+    args.incremental = false;             // toggle, only process rows appended since the last run
+    args.threads = 1;                     // amount of threads that scan the CSV
+    args.read_ahead = false;              // toggle, read the CSV with several reads in flight instead of mapping it
+    args.build_index = false;             // toggle, only build an index of the column instead of extracting words
+    args.build_cache = false;             // toggle, only build a columnar cache of the CSV instead of extracting words
+    args.serve = false;                   // toggle, answer queries until stopped instead of running once
+    args.stats = false;                   // toggle, print time spent in each phase and counters
     args.verbose = false;                 // toggle, print a lot of information
+    args.log_level = Logger::level_t::ok;  // print everything but debug messages
+    // print messages from a background thread, so workers never wait on the terminal
+    Logger::start(args.log_level);
     if (ConsoleInput::parse_args(args)) {
-        if (!ProcessCSV::find_and_save(args)) {
+        if (args.stats || !args.filename_stats.empty()) {
+            Stats::enable();
+        }
+        bool success;
+        if (args.serve) {
+            success = Server::serve(args);
+        }
+        else if (args.build_index || args.build_cache) {
+            success = ProcessCSV::build(args);
+        }
+        else {
+            success = ProcessCSV::find_and_save(args);
+        }
+        if (args.stats) {
+            Logger::flush();  // don't interleave the summary with queued messages
+            Stats::print_summary();
+        }
+        if (!args.filename_stats.empty() && !Stats::save_json(args.filename_stats)) {
+            Logger::error() << "failed to save stats to '" << args.filename_stats << "'.";
+        }
+        if (!success) {
             return -1;
         }
-        std::cout << "INFO: CSV file was processed successfully, see '"
-                  << args.filename_output << "'.\n";
     }
     return 0;
 }